@@ -41,7 +41,7 @@ size_t BitStream::iterator_base::allocate(size_t count, bool sign_offset){
 
 	size_t n_alloc = 0;
 	size_t bit_count = sign_offset * offset + count;
-	std::vector<uint8_t>::iterator it;
+	bytes_t::iterator it;
 
 	if(bit_count > m_bs->m_bit_count){
 		size_t excess = bit_count - m_bs->m_bit_count;
@@ -564,6 +564,44 @@ const BitStream::bit_proxy BitStream::const_reverse_iterator::operator*() const{
 	return bit_proxy(*this);
 }
 
+/* BitStream::rolling_hash implementation */
+
+BitStream::rolling_hash::rolling_hash(const BitStream& bs, size_t window, size_t offset):
+	m_cbs(&bs), m_window(window), m_offset(offset), m_value(0), m_power(1)
+{
+	for(size_t i=1; i<m_window; ++i)
+		m_power = mulmod(m_power, BASE);
+
+	// Horner's rule over the window, 64 bits per load
+	for(size_t i=0; i<m_window; i+=64){
+		size_t count = m_window - i < 64 ? m_window - i : 64;
+		uint64_t word = m_cbs->load(m_offset + i, count);
+		for(size_t j=0; j<count; ++j, word>>=1)
+			m_value = (mulmod(m_value, BASE) + (word & 1)) % MODULO;
+	}
+}
+
+bool BitStream::rolling_hash::roll(size_t n){
+	for(; n; --n){
+		if(!m_window || m_offset + m_window >= m_cbs->m_bit_count){
+			m_offset += n;
+			return false;
+		}
+		uint64_t out = m_cbs->load(m_offset, 1);
+		uint64_t in = m_cbs->load(m_offset + m_window, 1);
+		m_value = (m_value + MODULO - (out ? m_power : 0)) % MODULO;
+		m_value = (mulmod(m_value, BASE) + in) % MODULO;
+		++m_offset;
+	}
+	return true;
+}
+
+uint64_t BitStream::rolling_hash::mulmod(uint64_t a, uint64_t b){
+	unsigned __int128 r = static_cast<unsigned __int128>(a) * b;
+	uint64_t lo = static_cast<uint64_t>(r & MODULO), hi = static_cast<uint64_t>(r >> 61);
+	return (lo + hi) % MODULO;
+}
+
 /* BitStream implementation */
 
 /* > Iterators < */
@@ -726,18 +764,20 @@ bool BitStream::get(const_reverse_iterator it) const{
 
 /* > Modifiers < */
 
-BitStream::BitStream(size_t bit_count, bool bit):
+BitStream::BitStream(size_t bit_count, bool bit, MemoryResource* resource):
 	m_bit_count(0), 
 	m_offset(0), 
+	m_bytes(resource), 
 	m_read_iterator(cbegin()), 
 	m_write_iterator(begin())
 {
 	reset(bit_count, bit);
 }
 
-BitStream::BitStream(const uint8_t* const src, size_t count, size_t offset, bool forward):
+BitStream::BitStream(const uint8_t* const src, size_t count, size_t offset, bool forward, MemoryResource* resource):
 	m_bit_count(0), 
 	m_offset(0), 
+	m_bytes(resource), 
 	m_read_iterator(cbegin()), 
 	m_write_iterator(begin())
 {
@@ -747,19 +787,27 @@ BitStream::BitStream(const uint8_t* const src, size_t count, size_t offset, bool
 		push(src, -1, count, offset, rend());
 }
 
-BitStream::BitStream(const std::string& bit_chars):
+BitStream::BitStream(const std::string& bit_chars, MemoryResource* resource):
 	m_bit_count(bit_chars.size()), 
 	m_offset(0), 
+	m_bytes(resource), 
 	m_read_iterator(cbegin()), 
 	m_write_iterator(begin())
 {
 	from_string(bit_chars);
 }
 
+BitStream::BitStream(const BitStream& bs, MemoryResource* resource):
+	m_bit_count(bs.m_bit_count), 
+	m_offset(bs.m_offset), 
+	m_bytes(bs.m_bytes, resource), 
+	m_read_iterator(cbegin()), 
+	m_write_iterator(begin())
+{}
+
 bool BitStream::any() const{
-	size_t ei = m_bit_count / 8 + (bool)(m_bit_count % 8);
-	for(size_t i=0; i<ei; ++i){
-		if(m_bytes[i]) return true;
+	for(size_t i=0; i<m_bit_count; i+=64){
+		if(load(i)) return true;
 	}
 	return false;
 }
@@ -769,17 +817,17 @@ bool BitStream::none() const{
 }
 
 bool BitStream::all() const{
-	size_t ei = m_bit_count / 8 + (bool)(m_bit_count % 8);
-	for(size_t i=0; i<ei; ++i){
-		if(!m_bytes[i]) return false;
+	for(size_t i=0; i<m_bit_count; i+=64){
+		size_t count = m_bit_count - i < 64 ? m_bit_count - i : 64;
+		if(load(i, count) != (count == 64 ? ~0ULL : (1ULL << count) - 1)) return false;
 	}
 	return true;
 }
 
 size_t BitStream::count() const{
 	size_t out = 0;
-	for(auto it=cbegin(); it!=cend(); ++it)
-		out += *it;
+	for(size_t i=0; i<m_bit_count; i+=64)
+		out += __builtin_popcountll(load(i));
 	return out;
 }
 
@@ -822,6 +870,183 @@ void BitStream::shrink_to_fit(){
 	m_bytes.shrink_to_fit();
 }
 
+void BitStream::extend(size_t bit_count){
+	if(bit_count <= m_bit_count) return;
+
+	size_t old_count = m_bit_count;
+	iterator_base it(this, m_bit_count, 0);
+	it.allocate(bit_count - m_bit_count, true);
+
+	// the former gap bits may hold garbage
+	for(size_t i=old_count; i<bit_count; i+=64)
+		store(0, i, bit_count - i);
+}
+
+uint64_t BitStream::load_be64(const uint8_t* ptr){
+	uint64_t word;
+	::memcpy(&word, ptr, 8);
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	word = __builtin_bswap64(word);
+#endif
+	return word;
+}
+
+void BitStream::store_be64(uint8_t* ptr, uint64_t word){
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	word = __builtin_bswap64(word);
+#endif
+	::memcpy(ptr, &word, 8);
+}
+
+uint64_t BitStream::load(size_t offset, size_t count) const{
+	if(offset >= m_bit_count || !count) return 0;
+	if(count > 64) count = 64;
+	if(count > m_bit_count - offset) count = m_bit_count - offset;
+
+	// [s, e) is the bit interval in the buffer, most significant bit first
+	size_t e = gap() + m_bit_count - offset;
+	size_t s = e - count;
+	size_t ei = s / 8, sh = s % 8;
+	const uint8_t* ptr = m_bytes.data() + ei;
+
+	uint64_t word = 0;
+	if(ei + 8 <= m_bytes.size()){
+		word = load_be64(ptr);
+	} else{
+		for(size_t i=0; ei+i<m_bytes.size(); ++i)
+			word |= static_cast<uint64_t>(ptr[i]) << (56 - 8 * i);
+	}
+	if(sh){
+		uint8_t next = ei + 8 < m_bytes.size() ? ptr[8] : 0;
+		word = (word << sh) | (next >> (8 - sh));
+	}
+	return word >> (64 - count);
+}
+
+void BitStream::store(uint64_t word, size_t offset, size_t count){
+	if(offset >= m_bit_count || !count) return;
+	if(count > 64) count = 64;
+	if(count > m_bit_count - offset) count = m_bit_count - offset;
+
+	size_t e = gap() + m_bit_count - offset;
+	size_t s = e - count;
+
+	if(count == 64 && !(s % 8)){
+		store_be64(m_bytes.data() + s / 8, word);
+		return;
+	}
+
+	uint64_t mask = count == 64 ? ~0ULL : (1ULL << count) - 1;
+	word &= mask;
+	for(size_t ei=s/8; ei<=(e-1)/8; ++ei){
+		// distance between the LSB of the word and that of the byte
+		long lo = static_cast<long>(e) - 8 * static_cast<long>(ei + 1);
+		uint8_t bits = lo >= 0 ? word >> lo : word << -lo;
+		uint8_t bmask = lo >= 0 ? mask >> lo : mask << -lo;
+		m_bytes[ei] = (m_bytes[ei] & ~bmask) | bits;
+	}
+}
+
+uint64_t BitStream::addc(uint64_t a, uint64_t b, bool& carry){
+#if defined(__clang__)
+	unsigned long long c;
+	uint64_t sum = __builtin_addcll(a, b, carry, &c);
+	carry = c;
+#else
+	uint64_t sum;
+	bool c1 = __builtin_add_overflow(a, b, &sum);
+	bool c2 = __builtin_add_overflow(sum, static_cast<uint64_t>(carry), &sum);
+	carry = c1 | c2;
+#endif
+	return sum;
+}
+
+uint64_t BitStream::subb(uint64_t a, uint64_t b, bool& borrow){
+#if defined(__clang__)
+	unsigned long long c;
+	uint64_t diff = __builtin_subcll(a, b, borrow, &c);
+	borrow = c;
+#else
+	uint64_t diff;
+	bool c1 = __builtin_sub_overflow(a, b, &diff);
+	bool c2 = __builtin_sub_overflow(diff, static_cast<uint64_t>(borrow), &diff);
+	borrow = c1 | c2;
+#endif
+	return diff;
+}
+
+bool BitStream::add(const BitStream& bs, bool carry){
+	extend(bs.m_bit_count);
+
+	for(size_t i=0; i<m_bit_count; i+=64){
+		size_t count = m_bit_count - i < 64 ? m_bit_count - i : 64;
+		uint64_t sum = addc(load(i, count), bs.load(i, count), carry);
+		if(count < 64)
+			carry = (sum >> count) & 1;
+		store(sum, i, count);
+	}
+	return carry;
+}
+
+bool BitStream::sub(const BitStream& bs, bool borrow){
+	extend(bs.m_bit_count);
+
+	for(size_t i=0; i<m_bit_count; i+=64){
+		size_t count = m_bit_count - i < 64 ? m_bit_count - i : 64;
+		uint64_t diff = subb(load(i, count), bs.load(i, count), borrow);
+		if(count < 64)
+			borrow = (diff >> count) & 1;
+		store(diff, i, count);
+	}
+	return borrow;
+}
+
+bool BitStream::increment(){
+	bool carry = 1;
+	for(size_t i=0; i<m_bit_count && carry; i+=64){
+		size_t count = m_bit_count - i < 64 ? m_bit_count - i : 64;
+		uint64_t sum = addc(load(i, count), 0, carry);
+		if(count < 64)
+			carry = (sum >> count) & 1;
+		store(sum, i, count);
+	}
+	return carry;
+}
+
+bool BitStream::decrement(){
+	bool borrow = 1;
+	for(size_t i=0; i<m_bit_count && borrow; i+=64){
+		size_t count = m_bit_count - i < 64 ? m_bit_count - i : 64;
+		uint64_t diff = subb(load(i, count), 0, borrow);
+		if(count < 64)
+			borrow = (diff >> count) & 1;
+		store(diff, i, count);
+	}
+	return borrow;
+}
+
+int BitStream::compare(const BitStream& bs) const{
+	size_t count = m_bit_count > bs.m_bit_count ? m_bit_count : bs.m_bit_count;
+	for(size_t i=(count+63)/64; i; --i){
+		uint64_t a = load(64 * (i - 1)), b = bs.load(64 * (i - 1));
+		if(a != b)
+			return a < b ? -1 : 1;
+	}
+	return 0;
+}
+
+int BitStream::lcompare(const BitStream& bs) const{
+	size_t count = m_bit_count < bs.m_bit_count ? m_bit_count : bs.m_bit_count;
+	for(size_t i=0; i<count; i+=64){
+		uint64_t a = load(i, count - i), b = bs.load(i, count - i);
+		if(a != b)
+			return (a >> __builtin_ctzll(a ^ b)) & 1 ? 1 : -1;
+	}
+	if(m_bit_count == bs.m_bit_count)
+		return 0;
+	return m_bit_count < bs.m_bit_count ? -1 : 1;
+}
+
 void BitStream::assign(const uint8_t* const src, size_t size, size_t count, size_t offset, bool forward){
 	if(!src) return;
 	if(count + offset > 8 * size) count = offset >= 8 * size ? 0 : 8 * size - offset;
@@ -1026,10 +1251,64 @@ void BitStream::pop(reverse_iterator it1, reverse_iterator it2){
 }
 
 void BitStream::shift(size_t n, iterator_base it1, iterator_base it2){
-	rotate(n, it1, it2);
-	iterator_base tmp = it1 + n;
-	for(; it1!=tmp; ++it1)
-		it1.set(0);
+	// [lo, hi) is the interval in terms of forward offsets
+	bool forward = !it1.is_reverse();
+	size_t lo = forward ? it1.offset : m_bit_count - it2.offset;
+	size_t hi = forward ? it2.offset : m_bit_count - it1.offset;
+	if(!n || hi <= lo) return;
+	if(n > hi - lo) n = hi - lo;
+
+	if(lo == 0 && hi == m_bit_count){
+		shift_buffer(n, forward);
+	} else if(forward){
+		for(size_t i=hi; i>lo+n; ){
+			size_t count = i - (lo + n) < 64 ? i - (lo + n) : 64;
+			i -= count;
+			store(load(i - n, count), i, count);
+		}
+	} else{
+		for(size_t i=lo; i+n<hi; ){
+			size_t count = hi - (i + n) < 64 ? hi - (i + n) : 64;
+			store(load(i + n, count), i, count);
+			i += count;
+		}
+	}
+
+	// shifted in bits
+	size_t zero = forward ? lo : hi - n;
+	for(size_t i=0; i<n; i+=64)
+		store(0, zero + i, n - i);
+}
+
+void BitStream::shift_buffer(size_t n, bool front){
+	size_t size = m_bytes.size();
+	size_t q = n / 8, r = n % 8;
+	uint8_t* ptr = m_bytes.data();
+	if(q >= size) return;
+
+	if(front){
+		::memmove(ptr, ptr + q, size - q);
+		size -= q;
+		if(!r) return;
+
+		size_t i = 0;
+		for(; i+8<size; i+=8)
+			store_be64(ptr + i, (load_be64(ptr + i) << r) | (ptr[i+8] >> (8 - r)));
+		for(; i<size; ++i)
+			ptr[i] = (ptr[i] << r) | (i + 1 < size ? ptr[i+1] >> (8 - r) : 0);
+	} else{
+		::memmove(ptr + q, ptr, size - q);
+		ptr += q;
+		size -= q;
+		if(!r) return;
+
+		size_t i = size;
+		for(; i>=9; i-=8)
+			store_be64(ptr + i - 8, (load_be64(ptr + i - 8) >> r) | 
+					(static_cast<uint64_t>(ptr[i-9]) << (64 - r)));
+		for(; i; --i)
+			ptr[i-1] = (ptr[i-1] >> r) | (i > 1 ? ptr[i-2] << (8 - r) : 0);
+	}
 }
 
 void BitStream::shift(size_t n, iterator it1, iterator it2){
@@ -1192,7 +1471,7 @@ void BitStream::memflp(size_t n, reverse_iterator it){
 }
 
 BitStream BitStream::substream(iterator_base it1, iterator_base it2) const{
-	BitStream bs;
+	BitStream bs(0, 0, resource());
 	size_t count = it2 - it1;
 	if(count > m_bit_count){
 		fprintf(stderr, 
@@ -1241,6 +1520,144 @@ BitStream BitStream::substream(const_reverse_iterator it, size_t offset) const{
 	return substream(static_cast<iterator_base>(it), static_cast<iterator_base>(it+offset));
 }
 
+BitStream BitStream::extract(const BitStream& mask) const{
+	BitStream out(mask.count(), 0, resource());
+
+	size_t pos = 0;
+	for(size_t i=0; i<mask.m_bit_count; i+=64){
+		uint64_t m = mask.load(i);
+		if(!m) continue;
+		size_t count = __builtin_popcountll(m);
+		out.store(pext64(load(i), m), pos, count);
+		pos += count;
+	}
+	return out;
+}
+
+BitStream BitStream::deposit(const BitStream& compact, const BitStream& mask){
+	BitStream out(mask.m_bit_count, 0, compact.resource());
+
+	size_t pos = 0;
+	for(size_t i=0; i<mask.m_bit_count; i+=64){
+		uint64_t m = mask.load(i);
+		if(!m) continue;
+		size_t count = __builtin_popcountll(m);
+		out.store(pdep64(compact.load(pos, count), m), i);
+		pos += count;
+	}
+	return out;
+}
+
+uint64_t BitStream::pext64(uint64_t word, uint64_t mask){
+#ifdef __BMI2__
+	return _pext_u64(word, mask);
+#else
+	// table[m][b] = pext of byte `b` under byte mask `m`
+	static const std::vector<uint8_t> table = []{
+		std::vector<uint8_t> t(256 * 256);
+		for(size_t m=0; m<256; ++m){
+			for(size_t b=0; b<256; ++b){
+				uint8_t out = 0;
+				for(size_t i=0, k=0; i<8; ++i){
+					if(BIT_AT(i, m))
+						out |= BIT_AT(i, b) << k++;
+				}
+				t[256 * m + b] = out;
+			}
+		}
+		return t;
+	}();
+
+	uint64_t out = 0;
+	for(size_t i=0, k=0; i<64 && mask; i+=8, mask>>=8, word>>=8){
+		uint8_t m = mask & 0xff;
+		if(!m) continue;
+		out |= static_cast<uint64_t>(table[256 * m + (word & 0xff)]) << k;
+		k += __builtin_popcount(m);
+	}
+	return out;
+#endif
+}
+
+uint64_t BitStream::pdep64(uint64_t word, uint64_t mask){
+#ifdef __BMI2__
+	return _pdep_u64(word, mask);
+#else
+	// table[m][b] = pdep of the low bits of `b` onto byte mask `m`
+	static const std::vector<uint8_t> table = []{
+		std::vector<uint8_t> t(256 * 256);
+		for(size_t m=0; m<256; ++m){
+			for(size_t b=0; b<256; ++b){
+				uint8_t out = 0;
+				for(size_t i=0, k=0; i<8; ++i){
+					if(BIT_AT(i, m)){
+						out |= BIT_AT(k, b) << i;
+						++k;
+					}
+				}
+				t[256 * m + b] = out;
+			}
+		}
+		return t;
+	}();
+
+	uint64_t out = 0;
+	for(size_t i=0; i<64 && mask; i+=8, mask>>=8){
+		uint8_t m = mask & 0xff;
+		if(!m) continue;
+		out |= static_cast<uint64_t>(table[256 * m + (word & 0xff)]) << i;
+		word >>= __builtin_popcount(m);
+	}
+	return out;
+#endif
+}
+
+uint64_t BitStream::hash_word(uint64_t word, uint64_t seed){
+	// wyhash-like multiply-fold mixing
+	unsigned __int128 r = static_cast<unsigned __int128>(word ^ 0xa0761d6478bd642fULL) * 
+		(seed ^ 0xe7037ed1a0b428dbULL);
+	return static_cast<uint64_t>(r) ^ static_cast<uint64_t>(r >> 64);
+}
+
+uint64_t BitStream::hash(const_iterator it1, const_iterator it2, uint64_t seed) const{
+	size_t lo = it1.offset, hi = it2.offset;
+	if(hi < lo) hi = lo;
+
+	uint64_t h = seed;
+	for(size_t i=lo; i<hi; i+=64)
+		h = hash_word(load(i, hi - i), h);
+	return hash_word(hi - lo, h ^ 0x8ebc6af09c88c6e3ULL);
+}
+
+uint64_t BitStream::hash(const_reverse_iterator it1, const_reverse_iterator it2, uint64_t seed) const{
+	size_t lo = it1.offset, hi = it2.offset;
+	if(hi < lo) hi = lo;
+
+	// same words as the forward version would see on the reversed sequence
+	uint64_t h = seed;
+	for(size_t i=lo; i<hi; i+=64){
+		size_t count = hi - i < 64 ? hi - i : 64;
+		h = hash_word(reverse64(load(m_bit_count - i - count, count)) >> (64 - count), h);
+	}
+	return hash_word(hi - lo, h ^ 0x8ebc6af09c88c6e3ULL);
+}
+
+uint64_t BitStream::hash(uint64_t seed) const{
+	return hash(cbegin(), cend(), seed);
+}
+
+BitStream::rolling_hash BitStream::rolling(size_t window, size_t offset) const{
+	return rolling_hash(*this, window, offset);
+}
+
+uint64_t BitStream::reverse64(uint64_t word){
+	word = __builtin_bswap64(word);
+	word = ((word >> 4) & 0x0f0f0f0f0f0f0f0fULL) | ((word & 0x0f0f0f0f0f0f0f0fULL) << 4);
+	word = ((word >> 2) & 0x3333333333333333ULL) | ((word & 0x3333333333333333ULL) << 2);
+	word = ((word >> 1) & 0x5555555555555555ULL) | ((word & 0x5555555555555555ULL) << 1);
+	return word;
+}
+
 std::ostream& BitStream::print(std::ostream& out, bool forward) const{
 	int i=0;
 
@@ -1312,7 +1729,7 @@ const BitStream::bit_proxy BitStream::operator[](size_t offset) const{
 }
 
 BitStream BitStream::operator~() const{
-	BitStream out = *this;
+	BitStream out(*this, resource());
 	for(auto& byte: out.m_bytes)
 		out = ~out;
 	return out;
@@ -1320,7 +1737,7 @@ BitStream BitStream::operator~() const{
 
 BitStream BitStream::operator&(const BitStream& bs) const{
 	size_t count = m_bit_count > bs.m_bit_count ? m_bit_count : bs.m_bit_count;
-	BitStream out(count, 0);
+	BitStream out(count, 0, resource());
 	for(size_t i=0; i<count/8; ++i)
 		out.m_bytes[i] = m_bytes[i] & bs.m_bytes[i];
 	return out;
@@ -1328,7 +1745,7 @@ BitStream BitStream::operator&(const BitStream& bs) const{
 
 BitStream BitStream::operator|(const BitStream& bs) const{
 	size_t count = m_bit_count > bs.m_bit_count ? m_bit_count : bs.m_bit_count;
-	BitStream out(count, 0);
+	BitStream out(count, 0, resource());
 	for(size_t i=0; i<count/8; ++i)
 		out.m_bytes[i] = m_bytes[i] | bs.m_bytes[i];
 	return out;
@@ -1336,21 +1753,21 @@ BitStream BitStream::operator|(const BitStream& bs) const{
 
 BitStream BitStream::operator^(const BitStream& bs) const{
 	size_t count = m_bit_count > bs.m_bit_count ? m_bit_count : bs.m_bit_count;
-	BitStream out(count, 0);
+	BitStream out(count, 0, resource());
 	for(size_t i=0; i<count/8; ++i)
 		out.m_bytes[i] = m_bytes[i] ^ bs.m_bytes[i];
 	return out;
 }
 
 BitStream BitStream::operator<<(size_t n) const{
-	BitStream out = *this;
-	out.shift(n, out.rbegin(), out.rend());
+	BitStream out(*this, resource());
+	out <<= n;
 	return out;
 }
 
 BitStream BitStream::operator>>(size_t n) const{
-	BitStream out = *this;
-	out.shift(n, out.begin(), out.end());
+	BitStream out(*this, resource());
+	out >>= n;
 	return out;
 }
 
@@ -1386,8 +1803,8 @@ bool BitStream::operator==(const BitStream& bs) const{
 	if(m_bit_count != bs.m_bit_count)
 		return false;
 
-	for(size_t i=0; i<m_bytes.size(); ++i){
-		if(m_bytes[i] != bs.m_bytes[i])
+	for(size_t i=0; i<m_bit_count; i+=64){
+		if(load(i) != bs.load(i))
 			return false;
 	}
 	return true;
@@ -1398,77 +1815,90 @@ bool BitStream::operator!=(const BitStream& bs) const{
 }
 
 bool BitStream::operator<(const BitStream& bs) const{
-	size_t excess = 0;
-	uint8_t chunks[2];
-
-	const_reverse_iterator begins[2], ends[2];
-	begins[0] = crbegin(); begins[1] = bs.crbegin();
-	ends[0] = crend(); ends[1] = bs.crend();
-
-	if(m_bit_count > bs.m_bit_count){
-		excess = m_bit_count - bs.m_bit_count;
-		for(size_t i=0; i<excess; ++i, ++begins[0]){
-			if(begins[0].get()) return false;
-		}
-	} else{
-		excess = bs.m_bit_count - m_bit_count;
-		for(size_t i=0; i<excess; ++i, ++begins[1]){
-			if(begins[1].get()) return true;
-		}
-	}
-
-	for(; begins[0]!=ends[0] && begins[1]!=ends[1]; ++begins[0], ++begins[1]){
-		if(begins[0].get() < begins[1].get()) return true;
-	}
-	return false;
+	return compare(bs) < 0;
 }
 
 bool BitStream::operator>(const BitStream& bs) const{
-	return (*this != bs) && !(*this < bs);
+	return compare(bs) > 0;
 }
 
 bool BitStream::operator<=(const BitStream& bs) const{
-	return (*this < bs) || (*this == bs);
+	return compare(bs) <= 0;
 }
 
 bool BitStream::operator>=(const BitStream& bs) const{
-	return (*this > bs) || (*this == bs);
+	return compare(bs) >= 0;
 }
 
 BitStream BitStream::operator+(const BitStream& bs) const{
-	BitStream out = *this;
+	BitStream out(*this, resource());
 	out += bs;
 	return out;
 }
 
 BitStream BitStream::operator-(const BitStream& bs) const{
-	BitStream out = *this;
+	BitStream out(*this, resource());
 	out -= bs;
 	return out;
 }
 
+BitStream BitStream::operator*(const BitStream& bs) const{
+	BitStream out(*this, resource());
+	out *= bs;
+	return out;
+}
+
 BitStream& BitStream::operator+=(const BitStream& bs){
-	size_t count = m_bit_count > bs.m_bit_count ? m_bit_count : bs.m_bit_count;
-	bool carry = 0;
-	BitStream out(count, 0);
-	for(size_t i=0; i<count; ++i){
-		uint8_t tmp = operator[](i) + bs[i] + carry;
-		if(tmp == 2)
-			carry = 1;
-		else
-			carry = 0;
-		operator[](i) = tmp;
-	}
+	add(bs);
 	return *this;
 }
 
 BitStream& BitStream::operator-=(const BitStream& bs){
-	// TODO
+	sub(bs);
+	return *this;
+}
+
+BitStream& BitStream::operator*=(const BitStream& bs){
+	extend(bs.m_bit_count);
+
+	// shift-and-add on 64-bit words: every word of `this` contributes
+	// its partial product with `bs` shifted by the word position
+	size_t n = (m_bit_count + 63) / 64;
+	ResourceAllocator<uint64_t> allocator(resource());
+	std::vector<uint64_t, ResourceAllocator<uint64_t>> a(n, 0, allocator), b(n, 0, allocator), out(n, 0, allocator);
+	for(size_t i=0; i<n; ++i){
+		a[i] = load(64 * i);
+		b[i] = bs.load(64 * i);
+	}
+
+	for(size_t i=0; i<n; ++i){
+		if(!a[i]) continue;
+		uint64_t carry = 0;
+		for(size_t j=0; i+j<n; ++j){
+			unsigned __int128 p = static_cast<unsigned __int128>(a[i]) * b[j] + out[i+j] + carry;
+			out[i+j] = static_cast<uint64_t>(p);
+			carry = static_cast<uint64_t>(p >> 64);
+		}
+	}
+
+	for(size_t i=0; i<n; ++i)
+		store(out[i], 64 * i);
+	return *this;
+}
+
+BitStream& BitStream::operator++(){
+	increment();
+	return *this;
+}
+
+BitStream& BitStream::operator--(){
+	decrement();
 	return *this;
 }
 
 BitStream& BitStream::operator=(const BitStream& bs){
 	m_bit_count = bs.m_bit_count;
+	m_offset = bs.m_offset;
 	m_bytes = bs.m_bytes;
 	return *this;
 }
@@ -105,7 +105,9 @@ namespace alc{ namespace core{
 	}
 
 	bool Core::pull() const{
-		BitStream inputs(m_backward.size());
+		// pull recurses through the whole graph; recycle the tiny input buffers
+		static thread_local PoolResource pool;
+		BitStream inputs(m_backward.size(), 0, &pool);
 		for(size_t i=0; i<m_backward.size(); ++i){
 			if(!m_backward[i].second.speculative)
 				inputs[i] = m_backward[i].first.lock()->pull();
@@ -241,14 +243,14 @@ namespace alc{ namespace core{
 
 	void Core::update(){
 		m_depth = 0;
-		std::string tmp;
+		uint64_t tmp = m_backward.size();
 		for(const auto& core: m_backward){
 			if(m_depth <= core.first.lock()->depth())
 				m_depth = core.first.lock()->depth() + 1;
-			tmp += std::to_string(core.first.lock()->hash()) + ".";
+			tmp = BitStream::hash_word(core.first.lock()->hash(), tmp);
 		}
 		if(m_type != CoreType::DEFAULT)
-			m_hash = Core::hash_string(tmp);
+			m_hash = tmp;
 		for(auto& core: m_forward){
 			core.first.lock()->update();
 		}
@@ -0,0 +1,266 @@
+
+#ifndef _MEMORY_RESOURCE_
+#define _MEMORY_RESOURCE_
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+#include <type_traits>
+
+
+/* MemoryResource class
+ *
+ * Polymorphic source of memory (a C++11 take on std::pmr::memory_resource)
+ * that BitStream buffers are allocated from. Three resources are provided:
+ * 		1. NewDeleteResource - plain ::operator new/delete (the default)
+ * 		2. MonotonicResource - arena; nothing is freed until release()
+ * 		3. PoolResource - size-class free lists carved out of large chunks
+ *
+ * None of them are thread-safe.
+ */
+class MemoryResource{
+	public:
+	virtual ~MemoryResource() = default;
+
+	inline void* allocate(size_t bytes, size_t alignment=alignof(std::max_align_t)){
+		return do_allocate(bytes, alignment);
+	}
+	inline void deallocate(void* ptr, size_t bytes, size_t alignment=alignof(std::max_align_t)){
+		do_deallocate(ptr, bytes, alignment);
+	}
+	inline bool is_equal(const MemoryResource& resource) const{
+		return this == &resource || do_is_equal(resource);
+	}
+
+	// the resource used whenever none is specified
+	static inline MemoryResource* get_default();
+	// replaces the default resource and returns the previous one (nullptr restores new/delete)
+	static inline MemoryResource* set_default(MemoryResource* resource);
+
+	protected:
+	virtual void* do_allocate(size_t bytes, size_t alignment) = 0;
+	virtual void do_deallocate(void* ptr, size_t bytes, size_t alignment) = 0;
+	virtual bool do_is_equal(const MemoryResource&) const{ return false; }
+
+	private:
+	static inline MemoryResource*& default_resource();
+};
+
+class NewDeleteResource: public MemoryResource{
+	protected:
+	void* do_allocate(size_t bytes, size_t){
+		return ::operator new(bytes);
+	}
+	void do_deallocate(void* ptr, size_t, size_t){
+		::operator delete(ptr);
+	}
+	bool do_is_equal(const MemoryResource& resource) const{
+		return dynamic_cast<const NewDeleteResource*>(&resource) != nullptr;
+	}
+};
+
+inline MemoryResource* new_delete_resource(){
+	static NewDeleteResource resource;
+	return &resource;
+}
+
+MemoryResource*& MemoryResource::default_resource(){
+	static MemoryResource* resource = new_delete_resource();
+	return resource;
+}
+
+MemoryResource* MemoryResource::get_default(){
+	return default_resource();
+}
+
+MemoryResource* MemoryResource::set_default(MemoryResource* resource){
+	MemoryResource* out = default_resource();
+	default_resource() = resource ? resource : new_delete_resource();
+	return out;
+}
+
+/* MonotonicResource class
+ *
+ * Hands out memory by bumping a pointer inside chunks taken from the
+ * upstream resource. Each new chunk is twice as large as the previous one.
+ * Deallocation is a no-op; all the memory is given back at once by
+ * release() (or on destruction), which is what makes per-iteration
+ * temporaries cheap.
+ */
+class MonotonicResource: public MemoryResource{
+	private:
+	MemoryResource* m_upstream;
+	size_t m_next_size;
+	uint8_t* m_ptr;
+	size_t m_left;
+	std::vector<std::pair<void*, size_t>> m_chunks;
+
+	public:
+	explicit MonotonicResource(size_t initial_size=4096, MemoryResource* upstream=get_default()):
+		m_upstream(upstream), m_next_size(initial_size ? initial_size : 1), m_ptr(nullptr), m_left(0) {}
+	MonotonicResource(const MonotonicResource&) = delete;
+	MonotonicResource& operator=(const MonotonicResource&) = delete;
+	~MonotonicResource(){ release(); }
+
+	inline void release(){
+		for(const auto& chunk: m_chunks)
+			m_upstream->deallocate(chunk.first, chunk.second);
+		m_chunks.clear();
+		m_ptr = nullptr;
+		m_left = 0;
+	}
+	inline MemoryResource* upstream() const{ return m_upstream; }
+
+	protected:
+	void* do_allocate(size_t bytes, size_t alignment){
+		size_t pad = (alignment - reinterpret_cast<uintptr_t>(m_ptr) % alignment) % alignment;
+		if(!m_ptr || pad + bytes > m_left){
+			size_t size = m_next_size;
+			while(size < bytes + alignment)
+				size *= 2;
+			m_ptr = static_cast<uint8_t*>(m_upstream->allocate(size));
+			m_left = size;
+			m_chunks.push_back(std::make_pair(m_ptr, size));
+			m_next_size = 2 * size;
+			pad = (alignment - reinterpret_cast<uintptr_t>(m_ptr) % alignment) % alignment;
+		}
+		void* out = m_ptr + pad;
+		m_ptr += pad + bytes;
+		m_left -= pad + bytes;
+		return out;
+	}
+	void do_deallocate(void*, size_t, size_t) {}
+};
+
+/* PoolResource class
+ *
+ * Serves requests up to MAX_BLOCK_SIZE bytes from free lists of power-of-two
+ * size classes. Blocks of a class are carved out of chunks taken from the
+ * upstream resource and deallocated blocks go back to the free list of
+ * their class, so streams of similar sizes recycle each other's memory.
+ * Larger requests are forwarded to the upstream resource. release() gives
+ * all the chunks back at once.
+ */
+class PoolResource: public MemoryResource{
+	static const size_t MIN_BLOCK_SIZE = 16;
+	static const size_t MAX_BLOCK_SIZE = 4096;
+	static const size_t CLASS_COUNT = 9;	// 16 B ... 4 KB
+	static const size_t CHUNK_SIZE = 16384;
+
+	struct block_t{ block_t* next; };
+
+	private:
+	MemoryResource* m_upstream;
+	block_t* m_free[CLASS_COUNT];
+	std::vector<void*> m_chunks;
+
+	public:
+	explicit PoolResource(MemoryResource* upstream=get_default()): m_upstream(upstream){
+		for(auto& list: m_free)
+			list = nullptr;
+	}
+	PoolResource(const PoolResource&) = delete;
+	PoolResource& operator=(const PoolResource&) = delete;
+	~PoolResource(){ release(); }
+
+	inline void release(){
+		for(auto chunk: m_chunks)
+			m_upstream->deallocate(chunk, CHUNK_SIZE);
+		m_chunks.clear();
+		for(auto& list: m_free)
+			list = nullptr;
+	}
+	inline MemoryResource* upstream() const{ return m_upstream; }
+
+	protected:
+	void* do_allocate(size_t bytes, size_t alignment){
+		if(bytes > MAX_BLOCK_SIZE || alignment > MIN_BLOCK_SIZE)
+			return m_upstream->allocate(bytes, alignment);
+
+		size_t index = size_class(bytes);
+		if(!m_free[index])
+			refill(index);
+
+		block_t* block = m_free[index];
+		m_free[index] = block->next;
+		return block;
+	}
+	void do_deallocate(void* ptr, size_t bytes, size_t alignment){
+		if(bytes > MAX_BLOCK_SIZE || alignment > MIN_BLOCK_SIZE)
+			return m_upstream->deallocate(ptr, bytes, alignment);
+
+		size_t index = size_class(bytes);
+		block_t* block = static_cast<block_t*>(ptr);
+		block->next = m_free[index];
+		m_free[index] = block;
+	}
+
+	private:
+	static inline size_t size_class(size_t bytes){
+		size_t index = 0;
+		for(size_t size=MIN_BLOCK_SIZE; size<bytes; size*=2)
+			++index;
+		return index;
+	}
+
+	inline void refill(size_t index){
+		size_t size = MIN_BLOCK_SIZE << index;
+		uint8_t* chunk = static_cast<uint8_t*>(m_upstream->allocate(CHUNK_SIZE));
+		m_chunks.push_back(chunk);
+		for(size_t i=CHUNK_SIZE/size; i; --i){
+			block_t* block = reinterpret_cast<block_t*>(chunk + (i - 1) * size);
+			block->next = m_free[index];
+			m_free[index] = block;
+		}
+	}
+};
+
+/* ResourceAllocator class
+ *
+ * Standard allocator that forwards to a MemoryResource. Like
+ * std::pmr::polymorphic_allocator, it is not propagated on assignment/swap
+ * and a copy-constructed container falls back to the default resource.
+ */
+template<typename T>
+class ResourceAllocator{
+	template<typename U>
+	friend class ResourceAllocator;
+
+	private:
+	MemoryResource* m_resource;
+
+	public:
+	using value_type = T;
+	using propagate_on_container_copy_assignment = std::false_type;
+	using propagate_on_container_move_assignment = std::false_type;
+	using propagate_on_container_swap = std::false_type;
+
+	ResourceAllocator(MemoryResource* resource=MemoryResource::get_default()) noexcept:
+		m_resource(resource ? resource : MemoryResource::get_default()) {}
+	template<typename U>
+	ResourceAllocator(const ResourceAllocator<U>& allocator) noexcept:
+		m_resource(allocator.m_resource) {}
+
+	inline T* allocate(size_t n){
+		return static_cast<T*>(m_resource->allocate(n * sizeof(T), alignof(T)));
+	}
+	inline void deallocate(T* ptr, size_t n){
+		m_resource->deallocate(ptr, n * sizeof(T), alignof(T));
+	}
+	inline MemoryResource* resource() const{ return m_resource; }
+	inline ResourceAllocator select_on_container_copy_construction() const{
+		return ResourceAllocator();
+	}
+
+	template<typename U>
+	inline bool operator==(const ResourceAllocator<U>& allocator) const{
+		return m_resource->is_equal(*allocator.m_resource);
+	}
+	template<typename U>
+	inline bool operator!=(const ResourceAllocator<U>& allocator) const{
+		return !(*this == allocator);
+	}
+};
+
+#endif
@@ -0,0 +1,130 @@
+
+#ifndef _BIT_IO_
+#define _BIT_IO_
+
+#include <vector>
+#include <cstdint>
+#include <stddef.h>
+#include <string.h>
+
+
+/* BitWriter & BitReader classes
+ *
+ * Sequential counterparts of BitStream for the coders: bits are packed
+ * MSB-first (the first bit written is the most significant bit of the first
+ * byte) through a 64-bit accumulator, so a code costs a shift and an or
+ * instead of a buffer insertion per bit.
+ */
+class BitWriter{
+	private:
+	std::vector<uint8_t>* m_out;
+	uint64_t m_acc;		// pending bits in the low `m_count` bits
+	size_t m_count;
+	size_t m_bit_count;
+
+	public:
+	/* Args:
+	 * 	out	- buffer the bytes are appended to
+	 */
+	explicit BitWriter(std::vector<uint8_t>& out):
+		m_out(&out), m_acc(0), m_count(0), m_bit_count(0) {}
+
+	/* Args:
+	 * 	bits	- value whose `count` low bits are written (MSB first)
+	 * 	count	- number of bits [0, 32]
+	 */
+	inline void put(uint32_t bits, size_t count){
+		m_acc = (m_acc << count) | (bits & ((static_cast<uint64_t>(1) << count) - 1));
+		m_count += count;
+		m_bit_count += count;
+		if(m_count >= 32){
+			m_count -= 32;
+			uint32_t word = static_cast<uint32_t>(m_acc >> m_count);
+			size_t size = m_out->size();
+			m_out->resize(size + 4);
+			uint8_t* ptr = m_out->data() + size;
+			ptr[0] = word >> 24; ptr[1] = word >> 16; ptr[2] = word >> 8; ptr[3] = word;
+		}
+	}
+	inline void put_bit(bool bit){ put(bit, 1); }
+
+	// writes the pending bits padded with zeros to a whole byte; returns the padding
+	inline size_t flush(){
+		size_t padding = (8 - m_count % 8) % 8;
+		m_acc <<= padding;
+		m_count += padding;
+		while(m_count){
+			m_count -= 8;
+			m_out->push_back(static_cast<uint8_t>(m_acc >> m_count));
+		}
+		m_bit_count += padding;
+		m_acc = 0;
+		return padding;
+	}
+
+	inline size_t bit_count() const{ return m_bit_count; }
+};
+
+class BitReader{
+	private:
+	const uint8_t* m_data;
+	size_t m_size;
+	size_t m_pos;		// next byte to be loaded
+	uint64_t m_acc;		// loaded bits, the next one at the MSB
+	size_t m_count;
+
+	public:
+	/* Args:
+	 * 	data	- bytes written by a BitWriter
+	 * 	size	- number of bytes
+	 */
+	BitReader(const uint8_t* data, size_t size):
+		m_data(data), m_size(size), m_pos(0), m_acc(0), m_count(0) { refill(); }
+
+	// tops the accumulator up to at least 57 bits (zeros past the end)
+	inline void refill(){
+		if(m_count > 56)
+			return;
+		if(m_pos + 8 <= m_size){
+			uint64_t word;
+			memcpy(&word, m_data + m_pos, 8);
+			m_acc |= __builtin_bswap64(word) >> m_count;
+			m_pos += (63 - m_count) >> 3;
+			m_count |= 56;
+		} else{
+			while(m_count <= 56){
+				if(m_pos < m_size)
+					m_acc |= static_cast<uint64_t>(m_data[m_pos]) << (56 - m_count);
+				++m_pos;
+				m_count += 8;
+			}
+		}
+	}
+
+	// `count` (<= 57) next bits without consuming them; call refill first
+	inline uint64_t peek(size_t count) const{
+		return count ? m_acc >> (64 - count) : 0;
+	}
+	inline void skip(size_t count){
+		m_acc <<= count;
+		m_count -= count;
+	}
+	inline uint64_t get(size_t count){
+		if(m_count < count)
+			refill();
+		uint64_t bits = peek(count);
+		skip(count);
+		return bits;
+	}
+	inline bool get_bit(){ return get(1); }
+
+	inline const uint8_t* data() const{ return m_data; }
+	inline size_t size() const{ return m_size; }
+	// number of bits consumed so far
+	inline size_t position() const{ return 8 * m_pos - m_count; }
+	inline size_t bit_size() const{ return 8 * m_size; }
+	// true if more bits were consumed than there are in the buffer
+	inline bool overrun() const{ return position() > bit_size(); }
+};
+
+#endif
@@ -12,6 +12,11 @@
 #include <cassert>
 #include <iostream>
 #include <cstdio>
+#include <functional>
+#include "memory_resource.h"
+#ifdef __BMI2__
+#include <immintrin.h>
+#endif
 
 
 // generates (user-given) bit mask
@@ -58,10 +63,14 @@ class BitStream{
 	// ONLY FOR TESTING
 	friend class BitStreamTest;
 
+	public:
+	// byte buffer allocated from the stream's memory resource
+	using bytes_t = std::vector<uint8_t, ResourceAllocator<uint8_t>>;
+
 	private:
 	size_t m_bit_count;
 	uint8_t m_offset;
-	std::vector<uint8_t> m_bytes;
+	bytes_t m_bytes;
 
 	public:
 	class bit_proxy;
@@ -352,10 +361,50 @@ class BitStream{
 		}
 	};
 
+	/* Rolling hash class
+	 *
+	 * Polynomial (Rabin-Karp) hash modulo 2^61-1 of a window of `window` bits
+	 * that slides towards end() of the stream. Rolling by one bit costs O(1),
+	 * and two windows with the same bits have the same value regardless of
+	 * where they are in the stream (or in which stream they are).
+	 */
+	class rolling_hash{
+		static const uint64_t MODULO = (1ULL << 61) - 1;
+		static const uint64_t BASE = 0x5bd1e9955bd1e995ULL % MODULO;
+
+		const BitStream* m_cbs;
+		size_t m_window;
+		size_t m_offset;
+		uint64_t m_value;
+		uint64_t m_power;	// BASE^(window-1)
+
+		public:
+		inline rolling_hash(const BitStream& bs, size_t window, size_t offset=0);
+		~rolling_hash() = default;
+
+		inline uint64_t value() const{ return m_value; }
+		inline size_t offset() const{ return m_offset; }
+		inline size_t window() const{ return m_window; }
+		inline bool valid() const{ return m_offset + m_window <= m_cbs->m_bit_count; }
+
+		// slides the window by `n` bits; returns false if it runs past the end
+		inline bool roll(size_t n=1);
+
+		private:
+		static inline uint64_t mulmod(uint64_t a, uint64_t b);
+	};
+
 	public:
-	inline BitStream(size_t bit_count=0, bool bit=0);
-	inline BitStream(const uint8_t* const src, size_t count, size_t offset=0, bool forward=true);
-	inline BitStream(const std::string& bit_chars);
+	/* Args:
+	 * 	resource	- memory resource the buffer is allocated from
+	 *
+	 * 	Note: a copy-constructed stream uses the default resource (see
+	 * 	MemoryResource::get_default) unless one is given explicitly.
+	 */
+	inline BitStream(size_t bit_count=0, bool bit=0, MemoryResource* resource=MemoryResource::get_default());
+	inline BitStream(const uint8_t* const src, size_t count, size_t offset=0, bool forward=true, MemoryResource* resource=MemoryResource::get_default());
+	inline BitStream(const std::string& bit_chars, MemoryResource* resource=MemoryResource::get_default());
+	inline BitStream(const BitStream& bs, MemoryResource* resource);
 
 	/* Iterators */
 	inline iterator begin();
@@ -405,7 +454,8 @@ class BitStream{
 	inline size_t offset() const{ return m_offset; }
 	inline size_t gap() const{ return 8 * m_bytes.size() - (m_bit_count + m_offset); }
 	inline size_t buffer_size() const{ return 8 * m_bytes.size(); }
-	inline const std::vector<uint8_t>& buffer() const{ return m_bytes; }
+	inline const bytes_t& buffer() const{ return m_bytes; }
+	inline MemoryResource* resource() const{ return m_bytes.get_allocator().resource(); }
 	inline size_t max_size() const{ return 8 * m_bytes.max_size(); }
 	inline size_t capacity() const{ return 8 * m_bytes.capacity(); }
 	
@@ -447,6 +497,16 @@ class BitStream{
 	inline void reset(size_t bit_count, bool bit=0);
 	inline void shrink_to_fit();
 
+	/* Args:
+	 *
+	 * bit_count	- new bit count (ignored if not greater than the current one)
+	 *
+	 * Grows the stream towards end() by appending zero bits. Unlike `resize`,
+	 * the existing bits keep their offsets and therefore, the numeric value
+	 * of the stream is preserved.
+	 */
+	inline void extend(size_t bit_count);
+
 	/* Args:
 	 *
 	 * count	- how many bits to assign
@@ -537,6 +597,40 @@ class BitStream{
 	inline BitStream substream(reverse_iterator it, size_t offset) const;
 	inline BitStream substream(const_reverse_iterator it, size_t offset) const;
 
+	/* Args:
+	 *
+	 * mask		- which bits to select (bit `i` of the mask selects bit `i` of the stream)
+	 * compact	- bits to be scattered
+	 *
+	 * extract	- gathers the selected bits into a new stream (in order, from begin())
+	 * deposit	- scatters the bits of `compact` onto the set positions of `mask`,
+	 *			  the result has the size of the mask and is 0 elsewhere
+	 *
+	 * Both process 64 bits per step with BMI2 pext/pdep if compiled for it
+	 * (e.g. -mbmi2 or -march=native), with byte lookup tables otherwise.
+	 */
+	inline BitStream extract(const BitStream& mask) const;
+	static inline BitStream deposit(const BitStream& compact, const BitStream& mask);
+
+	/* Args:
+	 *
+	 * it1		- start iterator
+	 * it2		- stop iterator
+	 * seed		- initial state of the hash
+	 *
+	 * Returns a 64-bit hash of the bits in the interval [it1, it2). The bits
+	 * are consumed 64 at a time whatever their alignment in the buffer is
+	 * (unaligned head and tail included). Therefore, the same sequence of
+	 * bits hashes to the same value at any offset and in any stream.
+	 */
+	inline uint64_t hash(const_iterator it1, const_iterator it2, uint64_t seed=0) const;
+	inline uint64_t hash(const_reverse_iterator it1, const_reverse_iterator it2, uint64_t seed=0) const;
+	inline uint64_t hash(uint64_t seed=0) const;
+	inline rolling_hash rolling(size_t window, size_t offset=0) const;
+
+	// mixes a single word into the hash state `seed`
+	static inline uint64_t hash_word(uint64_t word, uint64_t seed);
+
 	inline std::ostream& print(std::ostream& out=std::cout, bool forward=true) const;
 	inline std::string to_string() const;
 	inline void from_string(const std::string& bit_chars);
@@ -590,6 +684,31 @@ class BitStream{
 	template<typename T>
 	static inline BitStream cast(const T& bits, size_t count=8*sizeof(T), size_t offset=0);
 
+	/* Args:
+	 *
+	 * bs			- the other operand
+	 * carry/borrow	- incoming carry/borrow
+	 *
+	 * Arithmetic on the stream as an unsigned integer whose least significant
+	 * bit is at begin(). The stream is extended to the wider of the two operands
+	 * and the result wraps around; the carry/borrow out of the most significant
+	 * bit is returned. All of them work on 64-bit words with carry propagation.
+	 */
+	inline bool add(const BitStream& bs, bool carry=0);
+	inline bool sub(const BitStream& bs, bool borrow=0);
+	inline bool increment();
+	inline bool decrement();
+
+	/*
+	 * compare	- numeric comparison (leading zeros do not matter)
+	 * lcompare	- lexicographic comparison of the bit sequences from begin()
+	 *
+	 * Both return a negative value, zero or a positive value if the stream
+	 * is less than, equal to or greater than `bs` respectively.
+	 */
+	inline int compare(const BitStream& bs) const;
+	inline int lcompare(const BitStream& bs) const;
+
 	/* Operators */
 	inline bit_proxy operator[](size_t offset);
 	inline const bit_proxy operator[](size_t offset) const;
@@ -616,9 +735,13 @@ class BitStream{
 
 	inline BitStream operator+(const BitStream& bs) const;
 	inline BitStream operator-(const BitStream& bs) const;
+	inline BitStream operator*(const BitStream& bs) const;
 
 	inline BitStream& operator+=(const BitStream& bs);
 	inline BitStream& operator-=(const BitStream& bs);
+	inline BitStream& operator*=(const BitStream& bs);
+	inline BitStream& operator++();
+	inline BitStream& operator--();
 
 	inline BitStream& operator=(const BitStream& bs);
 	inline BitStream& operator=(uint8_t byte);
@@ -721,9 +844,22 @@ class BitStream{
 	 * the substream is shifted in the direction of [it1 -> it2].
 	 * Some bits are shifted out, and therefore, some bits are lost after shifting.
 	 * Therfore, shifting preserves the stream size and need not keep unnessary bits.
+	 * The substream is shifted in place 64 bits at a time; shifting the whole
+	 * stream moves the buffer with a single memmove followed by one pass.
 	 */
 	inline void shift(size_t n, iterator_base it1, iterator_base it2);
 
+	/* Args:
+	 *
+	 * n		- shift amount in bits
+	 * front	- direction of the shift (towards m_bytes.begin() or m_bytes.end())
+	 *
+	 * Shifts the whole underlying buffer in place: whole bytes are moved
+	 * with memmove and the remaining sub-byte amount is funnel shifted
+	 * 64 bits at a time. Bits that are shifted in are not defined.
+	 */
+	inline void shift_buffer(size_t n, bool front);
+
 	/* Args:
 	 *
 	 * n	- rotate amount in bits
@@ -778,8 +914,46 @@ class BitStream{
 	 * on the caller bit stream.
 	 */
 	inline BitStream substream(iterator_base it1, iterator_base it2) const;
+
+	/* Args:
+	 *
+	 * word		- bits to be written
+	 * offset	- forward offset of the bit that maps to the LSB of the word
+	 * count	- how many bits to read/write (at most 64)
+	 *
+	 * Word-level accessors which the arithmetic (and other bulk operations)
+	 * are built upon. Bits beyond the end of the stream are read as 0 and
+	 * are never written. Therefore, the gap/offset bits of the buffer are
+	 * neither observed nor altered.
+	 */
+	inline uint64_t load(size_t offset, size_t count=64) const;
+	inline void store(uint64_t word, size_t offset, size_t count=64);
+
+	// big-endian 64-bit load/store of the underlying bytes
+	static inline uint64_t load_be64(const uint8_t* ptr);
+	static inline void store_be64(uint8_t* ptr, uint64_t word);
+
+	// reverses the order of the bits in a word
+	static inline uint64_t reverse64(uint64_t word);
+
+	// parallel bit extract/deposit on words (pext/pdep semantics)
+	static inline uint64_t pext64(uint64_t word, uint64_t mask);
+	static inline uint64_t pdep64(uint64_t word, uint64_t mask);
+
+	// add/subtract with carry/borrow in and out
+	static inline uint64_t addc(uint64_t a, uint64_t b, bool& carry);
+	static inline uint64_t subb(uint64_t a, uint64_t b, bool& borrow);
 };
 
+namespace std{
+	template<>
+	struct hash<BitStream>{
+		size_t operator()(const BitStream& bs) const{
+			return bs.hash();
+		}
+	};
+}
+
 #ifndef _BIT_STREAM_IMPLEMENTATION_
 #define _BIT_STREAM_IMPLEMENTATION_
 #include "bit_stream.cpp"
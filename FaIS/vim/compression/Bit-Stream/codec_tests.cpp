@@ -0,0 +1,276 @@
+#include <cppunit/TestAssert.h>
+#include <cppunit/TestRunner.h>
+#include <cppunit/TestResult.h>
+#include <cppunit/TestResultCollector.h>
+#include <cppunit/TestCase.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+
+#include <cstdio>
+#include <random>
+
+#include "../container/container.h"
+#include "../fse/fse.h"
+
+using namespace CppUnit;
+using namespace std;
+
+using bytes_t = std::vector<uint8_t>;
+
+
+class CodecTest: public CppUnit::TestFixture{
+	CPPUNIT_TEST_SUITE(CodecTest);
+
+	// Entropy coders
+	CPPUNIT_TEST(testHuffman);
+	CPPUNIT_TEST(testFse);
+
+	// Dictionary coders
+	CPPUNIT_TEST(testLzw);
+	CPPUNIT_TEST(testLzwPolicies);
+	CPPUNIT_TEST(testLz77);
+
+	// Block sorting
+	CPPUNIT_TEST(testBwt);
+
+	// Streams
+	CPPUNIT_TEST(testPipeline);
+	CPPUNIT_TEST(testContainer);
+	CPPUNIT_TEST(testCorruptedHeader);
+
+	// -------------------------------------------
+	CPPUNIT_TEST_SUITE_END();
+
+	private:
+	// empty, one byte, all-equal, random and text inputs
+	std::vector<bytes_t> inputs;
+
+	// temporary file holding `data`, positioned at its start
+	static FILE* file_of(const bytes_t& data){
+		FILE* file = tmpfile();
+		write_all(fileno(file), data.data(), data.size());
+		lseek(fileno(file), 0, SEEK_SET);
+		return file;
+	}
+
+	static bytes_t contents(FILE* file){
+		bytes_t data(lseek(fileno(file), 0, SEEK_END));
+		lseek(fileno(file), 0, SEEK_SET);
+		data.resize(read_all(fileno(file), data.data(), data.size()));
+		return data;
+	}
+
+	public:
+	void setUp(){
+		std::mt19937 random(2021);
+		bytes_t noise(50000);
+		for(auto& byte: noise)
+			byte = random();
+
+		std::string sentence = "the quick brown fox jumps over the lazy dog, ";
+		bytes_t text;
+		for(size_t i=0; i<2000; ++i)
+			text.insert(text.end(), sentence.begin(), sentence.begin() + (i % sentence.size()) + 1);
+
+		inputs = { bytes_t(), bytes_t(1, 'x'), bytes_t(10000, 'a'), noise, text };
+	}
+
+	void tearDown(){
+		inputs.clear();
+	}
+
+	// Entropy coders
+	void testHuffman(){
+		for(const auto& input: inputs){
+			std::string data(input.begin(), input.end());
+			auto compressed = huffman::compress(data);
+
+			// Assertions
+			CPPUNIT_ASSERT(huffman::decompress(compressed.first, compressed.second) == data);
+
+			for(bool shared_table: {false, true}){
+				bytes_t blocks = huffman::compress_blocks(input.data(), input.size(), 4096, shared_table), out;
+				CPPUNIT_ASSERT(huffman::decompress_blocks(blocks.data(), blocks.size(), out));
+				CPPUNIT_ASSERT(out == input);
+			}
+		}
+	}
+
+	void testFse(){
+		for(const auto& input: inputs){
+			FILE* raw = file_of(input);
+			FILE* compressed = tmpfile();
+			FILE* decompressed = tmpfile();
+
+			// Assertions
+			CPPUNIT_ASSERT(fse::compress(fileno(raw), fileno(compressed), 4096));
+			lseek(fileno(compressed), 0, SEEK_SET);
+			CPPUNIT_ASSERT(fse::decompress(fileno(compressed), fileno(decompressed)));
+			CPPUNIT_ASSERT(contents(decompressed) == input);
+
+			fclose(raw);
+			fclose(compressed);
+			fclose(decompressed);
+		}
+	}
+
+	// Dictionary coders
+	void testLzw(){
+		for(const auto& input: inputs){
+			std::string data(input.begin(), input.end());
+
+			// Assertions
+			CPPUNIT_ASSERT(lzw::decompress(lzw::compress(data)) == data);
+
+			bytes_t blocks = lzw::compress_blocks(input.data(), input.size(), 4096), out;
+			CPPUNIT_ASSERT(lzw::decompress_blocks(blocks.data(), blocks.size(), out));
+			CPPUNIT_ASSERT(out == input);
+		}
+	}
+
+	void testLzwPolicies(){
+		// 9 bit codes fill the dictionary after 256 new strings
+		for(lzw::policy_t policy: {lzw::FREEZE, lzw::RESET, lzw::PRUNE}){
+			for(const auto& input: inputs){
+				std::string data(input.begin(), input.end());
+
+				// Assertions
+				CPPUNIT_ASSERT(lzw::decompress(lzw::compress(data, lzw::MIN_CODE_WIDTH, policy)) == data);
+
+				bytes_t blocks = lzw::compress_blocks(input.data(), input.size(), 4096, 0, lzw::MIN_CODE_WIDTH, policy), out;
+				CPPUNIT_ASSERT(lzw::decompress_blocks(blocks.data(), blocks.size(), out));
+				CPPUNIT_ASSERT(out == input);
+			}
+		}
+	}
+
+	void testLz77(){
+		for(const auto& input: inputs){
+			for(size_t window_bits: {lz77::MIN_WINDOW_BITS, lz77::DEFAULT_WINDOW_BITS}){
+				bytes_t compressed = lz77::compress(input.data(), input.size(), window_bits), out;
+
+				// Assertions
+				CPPUNIT_ASSERT(lz77::decompress(compressed.data(), compressed.size(), out));
+				CPPUNIT_ASSERT(out == input);
+			}
+		}
+	}
+
+	// Block sorting
+	void testBwt(){
+		for(const auto& input: inputs){
+			for(size_t tables: {0, 4}){
+				bytes_t blocks = bwt::compress_blocks(input.data(), input.size(), 4096, 0, tables), out;
+
+				// Assertions
+				CPPUNIT_ASSERT(bwt::decompress_blocks(blocks.data(), blocks.size(), out));
+				CPPUNIT_ASSERT(out == input);
+			}
+		}
+	}
+
+	// Streams
+	void testPipeline(){
+		for(size_t id=0; id<pipeline::CODEC_COUNT; ++id){
+			pipeline::Pipeline chain;
+			chain.then(pipeline::make_codec(id));
+
+			for(const auto& input: inputs){
+				// the stream format never hands a codec an empty block
+				if(input.empty())
+					continue;
+				pipeline::block_t encoded, decoded;
+
+				// Assertions
+				CPPUNIT_ASSERT(chain.encode(input, encoded));
+				CPPUNIT_ASSERT(chain.decode(encoded, decoded));
+				CPPUNIT_ASSERT(decoded == input);
+			}
+		}
+
+		pipeline::Pipeline chain(4096);
+		chain.then(pipeline::make_codec("lz77")).then(pipeline::make_codec("huffman"));
+		for(const auto& input: inputs){
+			FILE* raw = file_of(input);
+			FILE* compressed = tmpfile();
+			FILE* decompressed = tmpfile();
+
+			// Assertions
+			CPPUNIT_ASSERT(chain.compress(fileno(raw), fileno(compressed)));
+			lseek(fileno(compressed), 0, SEEK_SET);
+			CPPUNIT_ASSERT(pipeline::Pipeline::decompress(fileno(compressed), fileno(decompressed)));
+			CPPUNIT_ASSERT(contents(decompressed) == input);
+
+			fclose(raw);
+			fclose(compressed);
+			fclose(decompressed);
+		}
+	}
+
+	void testContainer(){
+		for(const auto& input: inputs){
+			FILE* raw = file_of(input);
+			FILE* compressed = tmpfile();
+			FILE* decompressed = tmpfile();
+
+			// Assertions
+			CPPUNIT_ASSERT(container::compress(fileno(raw), fileno(compressed),
+				{pipeline::HUFFMAN, pipeline::LZW, pipeline::FSE}, 4096));
+			container::Reader reader(fileno(compressed));
+			CPPUNIT_ASSERT(reader.valid());
+			CPPUNIT_ASSERT(reader.size() == input.size());
+			CPPUNIT_ASSERT(reader.decompress(fileno(decompressed)));
+			CPPUNIT_ASSERT(contents(decompressed) == input);
+
+			// random access across a block boundary
+			if(input.size() > 5000){
+				bytes_t part(1000);
+				CPPUNIT_ASSERT(reader.read(4000, part.data(), part.size()) == part.size());
+				CPPUNIT_ASSERT(std::equal(part.begin(), part.end(), input.begin() + 4000));
+			}
+
+			fclose(raw);
+			fclose(compressed);
+			fclose(decompressed);
+		}
+	}
+
+	void testCorruptedHeader(){
+		const bytes_t& input = inputs[3];
+		bytes_t huffman_blocks = huffman::compress_blocks(input.data(), input.size(), 4096),
+				lzw_blocks = lzw::compress_blocks(input.data(), input.size(), 4096),
+				bwt_blocks = bwt::compress_blocks(input.data(), input.size(), 4096), out;
+
+		// the blocks claim to be 4 GiB each: the block count still matches,
+		// but the raw size is far beyond what the input can hold
+		for(bytes_t* blocks: {&huffman_blocks, &lzw_blocks, &bwt_blocks}){
+			uint64_t block_count = get_u32(blocks->data() + 16);
+			bytes_t header;
+			put_u64(header, (block_count - 1) * UINT32_MAX + 1);
+			put_u32(header, UINT32_MAX);
+			std::copy(header.begin(), header.end(), blocks->begin() + 4);
+		}
+
+		// Assertions
+		CPPUNIT_ASSERT(!huffman::decompress_blocks(huffman_blocks.data(), huffman_blocks.size(), out));
+		CPPUNIT_ASSERT(!lzw::decompress_blocks(lzw_blocks.data(), lzw_blocks.size(), out));
+		CPPUNIT_ASSERT(!bwt::decompress_blocks(bwt_blocks.data(), bwt_blocks.size(), out));
+
+		// truncated streams
+		CPPUNIT_ASSERT(!huffman::decompress_blocks(huffman_blocks.data(), 20, out));
+		CPPUNIT_ASSERT(!lzw::decompress_blocks(lzw_blocks.data(), 20, out));
+		CPPUNIT_ASSERT(!bwt::decompress_blocks(bwt_blocks.data(), 20, out));
+	}
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(CodecTest);
+
+int main(){
+	CppUnit::TextUi::TestRunner runner;
+	CppUnit::TestFactoryRegistry &registry = CppUnit::TestFactoryRegistry::getRegistry();
+  	runner.addTest( registry.makeTest() );
+  	bool wasSuccessful = runner.run( "", false );
+  	return !wasSuccessful;
+}
@@ -0,0 +1,115 @@
+
+#ifndef _CODEC_UTIL_
+#define _CODEC_UTIL_
+
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+#include <stddef.h>
+#include <errno.h>
+#include <unistd.h>
+
+
+/* Helpers shared by the codecs
+ *
+ * File descriptor I/O that retries short reads and writes, the big-endian
+ * integers of the container formats, and the block-parallel loop every
+ * codec's block format runs on.
+ */
+
+// reads exactly `size` bytes unless the input ends; returns the number read
+inline size_t read_all(int fd, void* dest, size_t size){
+	size_t total = 0;
+	while(total < size){
+		ssize_t n = read(fd, static_cast<uint8_t*>(dest) + total, size - total);
+		if(n < 0 && errno == EINTR)
+			continue;
+		if(n <= 0)
+			break;
+		total += n;
+	}
+	return total;
+}
+
+inline bool write_all(int fd, const void* src, size_t size){
+	size_t total = 0;
+	while(total < size){
+		ssize_t n = write(fd, static_cast<const uint8_t*>(src) + total, size - total);
+		if(n < 0 && errno == EINTR)
+			continue;
+		if(n <= 0)
+			return false;
+		total += n;
+	}
+	return true;
+}
+
+inline void put_u32(std::vector<uint8_t>& out, uint32_t value){
+	uint8_t bytes[4] = { 
+		static_cast<uint8_t>(value >> 24), static_cast<uint8_t>(value >> 16), 
+		static_cast<uint8_t>(value >> 8), static_cast<uint8_t>(value) 
+	};
+	out.insert(out.end(), bytes, bytes+4);
+}
+
+inline void put_u64(std::vector<uint8_t>& out, uint64_t value){
+	put_u32(out, value >> 32);
+	put_u32(out, value);
+}
+
+inline uint32_t get_u32(const uint8_t* src){
+	return (static_cast<uint32_t>(src[0]) << 24) | (static_cast<uint32_t>(src[1]) << 16) | 
+		(static_cast<uint32_t>(src[2]) << 8) | src[3];
+}
+
+inline uint64_t get_u64(const uint8_t* src){
+	return (static_cast<uint64_t>(get_u32(src)) << 32) | get_u32(src+4);
+}
+
+/* Args:
+ * 	index		- `count` big-endian u64 offsets of the blocks of a block format
+ * 	count		- number of blocks
+ * 	limit		- size of the blocks the offsets point into
+ *
+ * 	Returns true if the offsets are non-decreasing and within `limit`, so
+ * 	a header can be rejected before its output is allocated
+ */
+inline bool index_fits(const uint8_t* index, size_t count, uint64_t limit){
+	uint64_t prev = 0;
+	for(size_t i=0; i<count; ++i){
+		uint64_t offset = get_u64(index + 8 * i);
+		if(offset < prev || offset > limit)
+			return false;
+		prev = offset;
+	}
+	return true;
+}
+
+// calls `function(i)` for every i in [0, count) on up to `thread_count` threads
+template<typename F>
+inline void parallel_for(size_t count, size_t thread_count, const F& function){
+	if(!thread_count)
+		thread_count = std::thread::hardware_concurrency();
+	if(thread_count > count)
+		thread_count = count;
+	if(thread_count < 2){
+		for(size_t i=0; i<count; ++i)
+			function(i);
+		return;
+	}
+
+	std::atomic<size_t> next(0);
+	auto worker = [&](){
+		for(size_t i; (i = next++) < count; )
+			function(i);
+	};
+	std::vector<std::thread> threads;
+	for(size_t i=1; i<thread_count; ++i)
+		threads.emplace_back(worker);
+	worker();
+	for(auto& thread: threads)
+		thread.join();
+}
+
+#endif
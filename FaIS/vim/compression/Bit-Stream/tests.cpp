@@ -56,6 +56,11 @@ class BitStreamTest:	public BitStream,
 	CPPUNIT_TEST(testAND);
 	CPPUNIT_TEST(testOR);
 	CPPUNIT_TEST(testXOR);
+	CPPUNIT_TEST(testArithmetic);
+	CPPUNIT_TEST(testCompare);
+	CPPUNIT_TEST(testHash);
+	CPPUNIT_TEST(testExtractDeposit);
+	CPPUNIT_TEST(testResource);
 
 	// -------------------------------------------
 	CPPUNIT_TEST_SUITE_END();
@@ -409,6 +414,16 @@ class BitStreamTest:	public BitStream,
 		bs->print();
 		bs->shift(3, bs->rbegin()+18, bs->rend()-2);
 		bs->print();
+
+		bs->from_string("1011001110001111000011111000001111110000000111111100000000111");
+		*bs <<= 9;
+		CPPUNIT_ASSERT(bs->to_string() == "0001111000011111000001111110000000111111100000000111000000000");
+		*bs >>= 17;
+		CPPUNIT_ASSERT(bs->to_string() == "0000000000000000000011110000111110000011111100000001111111000");
+		CPPUNIT_ASSERT((*bs >> 100).none());
+
+		bs->shift(4, bs->begin()+20, bs->begin()+30);
+		CPPUNIT_ASSERT(bs->to_string() == "0000000000000000000000001111001110000011111100000001111111000");
 	}
 
 	void testRotate(){
@@ -485,6 +500,115 @@ class BitStreamTest:	public BitStream,
 	void testXOR(){
 		// Assertions
 	}
+
+	void testArithmetic(){
+		BitStream a(70, 1), b(3, 1);
+
+		// Assertions
+		CPPUNIT_ASSERT(a.add(b) == 1);
+		CPPUNIT_ASSERT(a.size() == 70);
+		CPPUNIT_ASSERT(a.count() == 2);
+		CPPUNIT_ASSERT(a[0] == 0 && a[1] == 1 && a[2] == 1 && a[3] == 0);
+
+		CPPUNIT_ASSERT(a.sub(b) == 1);
+		CPPUNIT_ASSERT(a.all() && a.count() == 70);
+
+		CPPUNIT_ASSERT(a.increment() == 1);
+		CPPUNIT_ASSERT(a.none());
+		CPPUNIT_ASSERT(a.decrement() == 1);
+		CPPUNIT_ASSERT(a.count() == 70);
+
+		b += BitStream(100, 0);
+		CPPUNIT_ASSERT(b.size() == 100);
+		CPPUNIT_ASSERT(b.count() == 3 && b[0] && b[1] && b[2]);
+
+		BitStream c("0000000000000000000000000000000000000000000000000000000000000001");
+		c.extend(130);
+		c = c * c;	// 2^63 * 2^63
+		CPPUNIT_ASSERT(c.size() == 130);
+		CPPUNIT_ASSERT(c.count() == 1 && c[126]);
+
+		c -= BitStream(1, 1);
+		CPPUNIT_ASSERT(c.count() == 126 && !c[126]);
+	}
+
+	void testHash(){
+		BitStream a("1011001110001111000011111000001111110000000111111100000000111"),
+				  b("00101100111000111100001111100000111111000000011111110000000011101");
+
+		// Assertions
+		CPPUNIT_ASSERT(a.hash() == b.hash(b.cbegin()+2, b.cend()-2));
+		CPPUNIT_ASSERT(a.hash() != b.hash());
+		CPPUNIT_ASSERT(a.hash(a.cbegin(), a.cbegin()+5) == BitStream("10110").hash());
+		CPPUNIT_ASSERT(a.hash(a.crbegin(), a.crbegin()+5) == BitStream("11100").hash());
+		CPPUNIT_ASSERT(std::hash<BitStream>()(a) == a.hash());
+
+		BitStream::rolling_hash rh = b.rolling(8);
+		uint64_t first = rh.value();
+		CPPUNIT_ASSERT(first == BitStream("00101100").rolling(8).value());
+		CPPUNIT_ASSERT(rh.roll(2) && rh.offset() == 2);
+		CPPUNIT_ASSERT(rh.value() == a.rolling(8).value());
+		CPPUNIT_ASSERT(!rh.roll(100) && !rh.valid());
+	}
+
+	void testExtractDeposit(){
+		BitStream bits("1011001110001111000011111000001111110000000111111100000000111"),
+				  mask("0110000000000000000000000000000000000000000000000000000000000001110011");
+
+		// Assertions
+		BitStream compact = bits.extract(mask);
+		CPPUNIT_ASSERT(compact.to_string() == "0100000");
+		
+		BitStream scattered = BitStream::deposit(compact, mask);
+		CPPUNIT_ASSERT(scattered.size() == mask.size());
+		CPPUNIT_ASSERT(scattered.to_string() == "0010000000000000000000000000000000000000000000000000000000000000000000");
+		CPPUNIT_ASSERT(scattered.extract(mask) == compact);
+	}
+
+	void testCompare(){
+		BitStream a("0110"), b("011000000"), c("1");
+
+		// Assertions
+		CPPUNIT_ASSERT(a.compare(b) == 0);
+		CPPUNIT_ASSERT(a != b);
+		CPPUNIT_ASSERT(a <= b && a >= b);
+		CPPUNIT_ASSERT(a.lcompare(b) < 0);
+		CPPUNIT_ASSERT(c < a && a > c);
+		CPPUNIT_ASSERT(c.lcompare(a) > 0);
+
+		BitStream d(200, 0), e(64, 1);
+		d[150] = 1;
+		CPPUNIT_ASSERT(e < d);
+		CPPUNIT_ASSERT(d.compare(e) > 0);
+		CPPUNIT_ASSERT(d.lcompare(e) < 0);
+	}
+
+	void testResource(){
+		MonotonicResource arena(64);
+		PoolResource pool;
+
+		BitStream a("10110011100011110000", &arena), b(100, 1, &pool);
+		for(size_t i=0; i<a.size(); ++i)
+			b.push(static_cast<bool>(a[i]), b.end());
+
+		// Assertions
+		CPPUNIT_ASSERT(a.resource() == &arena);
+		CPPUNIT_ASSERT(b.resource() == &pool);
+		CPPUNIT_ASSERT(a.to_string() == "10110011100011110000");
+		CPPUNIT_ASSERT(b.size() == 120 && b.count() == 110);
+		CPPUNIT_ASSERT((a + a).resource() == &arena);
+		CPPUNIT_ASSERT(BitStream(a).resource() == MemoryResource::get_default());
+
+		BitStream c(a, &pool);
+		CPPUNIT_ASSERT(c == a && c.resource() == &pool);
+		c = b;
+		CPPUNIT_ASSERT(c == b && c.resource() == &pool);
+
+		MemoryResource* previous = MemoryResource::set_default(&pool);
+		CPPUNIT_ASSERT(BitStream(8, 1).resource() == &pool);
+		MemoryResource::set_default(previous);
+		CPPUNIT_ASSERT(MemoryResource::get_default() == previous);
+	}
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(BitStreamTest);
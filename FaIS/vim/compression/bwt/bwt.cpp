@@ -0,0 +1,51 @@
+#include "bwt.h"
+
+using namespace std;
+using namespace bwt;
+
+// "-" stands for the standard input/output
+FILE* open_file(const char* path, bool output){
+	if(!strcmp(path, "-"))
+		return output ? stdout : stdin;
+	return fopen(path, output ? "wb" : "rb");
+}
+
+int main(int argc, const char** argv){
+	// -c/-d: whole file mode
+	const string mode = argc == 4 ? argv[1] : "";
+	if(mode == "-c" || mode == "-d"){
+		FILE* in = open_file(argv[2], false);
+		FILE* out = open_file(argv[3], true);
+		if(!in || !out){
+			fprintf(stderr, "ERROR: Unable to open %s!\n", in ? argv[3] : argv[2]);
+			return 1;
+		}
+
+		vector<uint8_t> src, dest;
+		uint8_t buffer[1 << 16];
+		for(size_t n; (n = fread(buffer, 1, sizeof(buffer), in)); )
+			src.insert(src.end(), buffer, buffer+n);
+		bool ok = true;
+		if(mode == "-c")
+			dest = compress_blocks(src.data(), src.size());
+		else
+			ok = decompress_blocks(src.data(), src.size(), dest);
+		ok = ok && fwrite(dest.data(), 1, dest.size(), out) == dest.size();
+		fclose(in);
+		fclose(out);
+		return !ok;
+	} else if(argc > 2){
+		fprintf(stderr, "Usage: %s [text] | -c <input> <output> | -d <input> <output>\n", argv[0]);
+		return 1;
+	}
+
+	string text = "hello, my name is world and this is an example of bwt compression, an example of bwt.";
+	if(argc == 2) text = string(argv[1]);
+	auto encoded = compress_blocks(reinterpret_cast<const uint8_t*>(text.data()), text.size());
+	vector<uint8_t> decoded;
+	decompress_blocks(encoded.data(), encoded.size(), decoded);
+	printf("%s\n", string(decoded.begin(), decoded.end()).c_str());
+	printf("Compression Ratio: %.3f\n", ((float)text.size()-encoded.size())/text.size());
+	printf("%zu - %zu\n", encoded.size(), text.size());
+	return 0;
+}
@@ -0,0 +1,426 @@
+
+#ifndef _BWT_
+#define _BWT_
+
+#include "../huffman/huffman.h"
+#include "../Bit-Stream/codec_util.h"
+
+
+namespace bwt{
+	// the inverse transform packs a row (< 2^24) and a byte in 32 bits
+	static const size_t MAX_BLOCK_SIZE = (1 << 24) - 1;
+	static const size_t BLOCK_SIZE = 1 << 20;
+	static const char BLOCKS_MAGIC[4] = { 'B', 'W', 'T', 'P' };
+
+	// zero runs of the MTF output, in bijective base 2 (least significant digit first)
+	static const uint8_t RUNA = 0;	// digit 1
+	static const uint8_t RUNB = 1;	// digit 2
+	// MTF indices >= ESCAPE_INDEX are sent as ESCAPE followed by index - ESCAPE_INDEX
+	static const uint8_t ESCAPE = 255;
+	static const size_t ESCAPE_INDEX = 254;
+
+	/* Args:
+	 * 	s	- string whose last symbol is 0 and the only 0
+	 * 	sa	- n entries, filled with the suffix array of `s`
+	 * 	n	- length of `s`
+	 * 	k	- alphabet size (symbols are < k)
+	 *
+	 * SA-IS (Nong, Zhang & Chan): LMS suffixes are sorted by induction
+	 * from their buckets, named, and sorted recursively when two of them
+	 * share a name; the order of the LMS suffixes then induces the order
+	 * of all the others. Linear time, and the reduced string lives in the
+	 * unused half of `sa`.
+	 */
+	template<typename T>
+	inline void sais(const T* s, int32_t* sa, size_t n, size_t k){
+		if(n == 1){
+			sa[0] = 0;
+			return;
+		}
+
+		// S-type: smaller than the next suffix
+		std::vector<bool> stype(n);
+		stype[n-1] = true;
+		for(size_t i=n-1; i--; )
+			stype[i] = s[i] < s[i+1] || (s[i] == s[i+1] && stype[i+1]);
+		auto lms = [&](int32_t i){ return i > 0 && stype[i] && !stype[i-1]; };
+
+		std::vector<int32_t> counts(k, 0), buckets(k);
+		for(size_t i=0; i<n; ++i)
+			++counts[s[i]];
+		auto starts = [&](){
+			for(size_t c=0, sum=0; c<k; sum+=counts[c++])
+				buckets[c] = sum;
+		};
+		auto ends = [&](){
+			for(size_t c=0, sum=0; c<k; ++c)
+				buckets[c] = sum += counts[c];
+		};
+		auto induce = [&](){
+			starts();
+			for(size_t i=0; i<n; ++i){
+				int32_t j = sa[i] - 1;
+				if(sa[i] > 0 && !stype[j])
+					sa[buckets[s[j]]++] = j;
+			}
+			ends();
+			for(size_t i=n; i--; ){
+				int32_t j = sa[i] - 1;
+				if(sa[i] > 0 && stype[j])
+					sa[--buckets[s[j]]] = j;
+			}
+		};
+
+		// sorts the LMS substrings
+		std::fill(sa, sa+n, -1);
+		ends();
+		for(size_t i=1; i<n; ++i){
+			if(lms(i))
+				sa[--buckets[s[i]]] = i;
+		}
+		induce();
+
+		size_t n1 = 0;
+		for(size_t i=0; i<n; ++i){
+			if(lms(sa[i]))
+				sa[n1++] = sa[i];
+		}
+
+		// names them: equal substrings get equal names
+		std::fill(sa+n1, sa+n, -1);
+		int32_t name = 0, prev = -1;
+		for(size_t i=0; i<n1; ++i){
+			int32_t pos = sa[i];
+			bool diff = prev < 0;
+			for(size_t d=0; !diff; ++d){
+				if(s[pos+d] != s[prev+d] || stype[pos+d] != stype[prev+d])
+					diff = true;
+				else if(d > 0 && (lms(pos+d) || lms(prev+d)))
+					break;
+			}
+			if(diff){
+				++name;
+				prev = pos;
+			}
+			sa[n1 + pos / 2] = name - 1;
+		}
+		for(size_t i=n, j=n; i-->n1; ){
+			if(sa[i] >= 0)
+				sa[--j] = sa[i];
+		}
+
+		// sorts the LMS suffixes, recursively if some names repeat
+		int32_t* s1 = sa + n - n1;
+		if(static_cast<size_t>(name) < n1){
+			sais(s1, sa, n1, name);
+		} else{
+			for(size_t i=0; i<n1; ++i)
+				sa[s1[i]] = i;
+		}
+
+		// induces the whole suffix array from the sorted LMS suffixes
+		for(size_t i=1, j=0; i<n; ++i){
+			if(lms(i))
+				s1[j++] = i;
+		}
+		for(size_t i=0; i<n1; ++i)
+			sa[i] = s1[sa[i]];
+		std::fill(sa+n1, sa+n, -1);
+		ends();
+		for(size_t i=n1; i--; ){
+			int32_t j = sa[i];
+			sa[i] = -1;
+			sa[--buckets[s[j]]] = j;
+		}
+		induce();
+	}
+
+	/* Args:
+	 * 	src		- input bytes
+	 * 	size	- number of bytes (at most MAX_BLOCK_SIZE)
+	 * 	dest	- `size` bytes, the last column of the sorted rotations of
+	 * 			  `src` + a sentinel smaller than any byte, without the sentinel
+	 *
+	 * 	Returns the row of the sentinel (the primary index)
+	 */
+	inline size_t forward(const uint8_t* src, size_t size, uint8_t* dest){
+		std::vector<uint16_t> s(size + 1);
+		for(size_t i=0; i<size; ++i)
+			s[i] = src[i] + 1;
+		s[size] = 0;
+		std::vector<int32_t> sa(size + 1);
+		sais(s.data(), sa.data(), size + 1, 257);
+
+		size_t primary = 0;
+		for(size_t i=0, j=0; i<=size; ++i){
+			if(sa[i])
+				dest[j++] = src[sa[i] - 1];
+			else
+				primary = i;
+		}
+		return primary;
+	}
+
+	/* Args:
+	 * 	src		- output of forward
+	 * 	size	- number of bytes
+	 * 	primary	- primary index returned by forward
+	 * 	dest	- `size` bytes, the input of forward
+	 *
+	 * The row following every row (LF mapping, walked from the first
+	 * column) is packed with its first byte in one word, so each output
+	 * byte costs a single random access.
+	 *
+	 * 	Returns false if the input is corrupted
+	 */
+	inline bool inverse(const uint8_t* src, size_t size, size_t primary, uint8_t* dest){
+		if(size > MAX_BLOCK_SIZE || !primary || primary > size)
+			return false;
+
+		// first row of every byte in the first column (row 0 holds the sentinel)
+		std::array<uint32_t, 256> rows;
+		huffman::histogram_t counts = huffman::histogram(src, size, 1);
+		for(size_t c=0, sum=1; c<256; sum+=counts[c++])
+			rows[c] = sum;
+
+		std::vector<uint32_t> next(size + 1);
+		for(size_t i=0; i<size; ++i){
+			uint32_t row = i < primary ? i : i + 1;
+			next[rows[src[i]]++] = row << 8 | src[i];
+		}
+
+		// the row of `src` + sentinel is the one ending with the sentinel
+		uint32_t row = primary;
+		for(size_t i=0; i<size; ++i){
+			uint32_t entry = next[row];
+			dest[i] = entry;
+			row = entry >> 8;
+		}
+		return true;
+	}
+
+	/* Args:
+	 * 	src		- output of forward
+	 * 	size	- number of bytes
+	 * 	out		- symbols appended: MTF indices, zero runs as RUNA/RUNB
+	 * 			  digits, other indices shifted by one (see ESCAPE)
+	 */
+	inline void encode_mtf(const uint8_t* src, size_t size, std::vector<uint8_t>& out){
+		uint8_t order[256];
+		for(size_t c=0; c<256; ++c)
+			order[c] = c;
+
+		size_t run = 0;
+		auto flush = [&](){
+			for(; run; run=(run-1)/2)
+				out.push_back(run & 1 ? RUNA : RUNB);
+		};
+		for(size_t i=0; i<size; ++i){
+			uint8_t c = src[i];
+			if(order[0] == c){
+				++run;
+				continue;
+			}
+			flush();
+
+			size_t index = 1;
+			uint8_t prev = order[0];
+			while(order[index] != c){
+				std::swap(prev, order[index]);
+				++index;
+			}
+			order[index] = prev;
+			order[0] = c;
+
+			if(index < ESCAPE_INDEX){
+				out.push_back(index + 1);
+			} else{
+				out.push_back(ESCAPE);
+				out.push_back(index - ESCAPE_INDEX);
+			}
+		}
+		flush();
+	}
+
+	/* Args:
+	 * 	src		- output of encode_mtf
+	 * 	size	- number of symbols
+	 * 	dest	- where the decoded bytes are written
+	 * 	count	- number of bytes expected
+	 *
+	 * 	Returns false if the input is corrupted
+	 */
+	inline bool decode_mtf(const uint8_t* src, size_t size, uint8_t* dest, size_t count){
+		uint8_t order[256];
+		for(size_t c=0; c<256; ++c)
+			order[c] = c;
+
+		size_t pos = 0, run = 0, weight = 1;
+		for(size_t i=0; i<=size; ++i){
+			uint8_t symbol = i < size ? src[i] : ESCAPE;
+			if(i < size && symbol <= RUNB){
+				run += weight << symbol;
+				weight <<= 1;
+				if(run > count - pos)
+					return false;
+				continue;
+			}
+			memset(dest + pos, order[0], run);
+			pos += run;
+			run = 0;
+			weight = 1;
+			if(i == size)
+				break;
+
+			size_t index = symbol - 1;
+			if(symbol == ESCAPE){
+				if(++i == size || src[i] > 255 - ESCAPE_INDEX)
+					return false;
+				index = ESCAPE_INDEX + src[i];
+			}
+			if(pos == count)
+				return false;
+			uint8_t c = order[index];
+			memmove(order + 1, order, index);
+			order[0] = c;
+			dest[pos++] = c;
+		}
+		return pos == count;
+	}
+
+	/* Block record
+	 *
+	 * 	primary index (u32), symbol count (u32), huffman record of the symbols
+	 *
+	 * Integers are big-endian. The raw size is known to the caller.
+	 */
+
+	/* Args:
+	 * 	src		- input bytes
+	 * 	size	- number of bytes (at most MAX_BLOCK_SIZE)
+	 * 	out		- buffer the record is appended to
+	 * 	tables	- order-1 huffman code tables (see huffman::encode_block)
+	 */
+	inline void encode_block(const uint8_t* src, size_t size, std::vector<uint8_t>& out, size_t tables=0){
+		std::vector<uint8_t> last(size), symbols;
+		size_t primary = forward(src, size, last.data());
+		symbols.reserve(size / 2);
+		encode_mtf(last.data(), size, symbols);
+
+		put_u32(out, primary);
+		put_u32(out, symbols.size());
+		huffman::encode_block(symbols.data(), symbols.size(), out, huffman::MAX_CODE_LENGTH, true, tables);
+	}
+
+	inline bool decode_block(const uint8_t* src, size_t size, uint8_t* dest, size_t count){
+		if(size < 8 || count > MAX_BLOCK_SIZE)
+			return false;
+		size_t primary = get_u32(src), symbol_count = get_u32(src+4);
+		// forward gives primary 0 to an empty block, the only block without a sentinel row > 0
+		if(!count)
+			return !primary && !symbol_count;
+		// a symbol stands for at least one byte, except the escaped ones (two symbols)
+		if(symbol_count > 2 * count)
+			return false;
+
+		std::vector<uint8_t> symbols(symbol_count), last(count);
+		return huffman::decode_block(src + 8, size - 8, symbols.data(), symbol_count) &&
+			decode_mtf(symbols.data(), symbol_count, last.data(), count) &&
+			inverse(last.data(), count, primary, dest);
+	}
+
+	/* Block format
+	 *
+	 * 	"BWTP" header index blocks
+	 * 	header	- raw size (u64), block size (u32), block count (u32)
+	 * 	index	- byte offset of every block from the start of the blocks (u64)
+	 * 	block	- block record (see encode_block)
+	 *
+	 * Blocks are transformed and coded independently, one block per worker
+	 * thread in both directions.
+	 */
+
+	/* Args:
+	 * 	src				- input bytes
+	 * 	size			- number of bytes
+	 * 	block_size		- input bytes per block (at most MAX_BLOCK_SIZE)
+	 * 	thread_count	- maximum number of worker threads (0: one per core)
+	 * 	tables			- order-1 huffman code tables (see huffman::encode_block)
+	 */
+	inline std::vector<uint8_t> compress_blocks(const uint8_t* src, size_t size, size_t block_size=BLOCK_SIZE,
+			size_t thread_count=0, size_t tables=0){
+		if(!block_size || block_size > MAX_BLOCK_SIZE)
+			block_size = BLOCK_SIZE;
+		size_t block_count = (size + block_size - 1) / block_size;
+
+		std::vector<std::vector<uint8_t>> blocks(block_count);
+		parallel_for(block_count, thread_count, [&](size_t i){
+			encode_block(src + i * block_size, std::min(block_size, size - i * block_size), blocks[i], tables);
+		});
+
+		std::vector<uint8_t> out(BLOCKS_MAGIC, BLOCKS_MAGIC+sizeof(BLOCKS_MAGIC));
+		put_u64(out, size);
+		put_u32(out, block_size);
+		put_u32(out, block_count);
+
+		size_t offset = 0;
+		for(const auto& block: blocks){
+			put_u64(out, offset);
+			offset += block.size();
+		}
+		out.reserve(out.size() + offset);
+		for(const auto& block: blocks)
+			out.insert(out.end(), block.cbegin(), block.cend());
+		return out;
+	}
+
+	/* Args:
+	 * 	src				- output of compress_blocks
+	 * 	size			- number of bytes
+	 * 	out				- decompressed bytes
+	 * 	thread_count	- maximum number of worker threads (0: one per core)
+	 *
+	 * 	Returns false if the input is corrupted
+	 */
+	inline bool decompress_blocks(const uint8_t* src, size_t size, std::vector<uint8_t>& out, size_t thread_count=0){
+		const size_t HEADER_SIZE = sizeof(BLOCKS_MAGIC) + 8 + 4 + 4;
+		if(size < HEADER_SIZE || !std::equal(BLOCKS_MAGIC, BLOCKS_MAGIC+sizeof(BLOCKS_MAGIC), reinterpret_cast<const char*>(src))){
+			fprintf(stderr, "WARNING[bwt::decompress_blocks]: Not a bwt block stream!\n");
+			return false;
+		}
+		uint64_t raw_size = get_u64(src+4);
+		size_t block_size = get_u32(src+12), block_count = get_u32(src+16);
+		if(!block_size || block_size > MAX_BLOCK_SIZE || block_count != (raw_size + block_size - 1) / block_size ||
+				(size - HEADER_SIZE) / 8 < block_count){
+			fprintf(stderr, "WARNING[bwt::decompress_blocks]: Corrupted header!\n");
+			return false;
+		}
+
+		const uint8_t* index = src + HEADER_SIZE;
+		const uint8_t* blocks = index + 8 * block_count;
+		size_t blocks_size = size - HEADER_SIZE - 8 * block_count;
+		// the index must fit the input, and a block record holds at least its primary index and symbol count
+		if(!index_fits(index, block_count, blocks_size) || blocks_size / 8 < block_count){
+			fprintf(stderr, "WARNING[bwt::decompress_blocks]: Corrupted header!\n");
+			return false;
+		}
+
+		out.resize(raw_size);
+		std::atomic<bool> ok(true);
+		parallel_for(block_count, thread_count, [&](size_t i){
+			// a block ends where the next one starts
+			uint64_t offset = get_u64(index + 8 * i);
+			uint64_t end = i+1 < block_count ? get_u64(index + 8 * (i+1)) : blocks_size;
+			size_t count = std::min<uint64_t>(block_size, raw_size - i * block_size);
+			if(!ok || end > blocks_size || offset > end ||
+					!decode_block(blocks + offset, end - offset, out.data() + i * block_size, count))
+				ok = false;
+		});
+
+		if(!ok)
+			fprintf(stderr, "WARNING[bwt::decompress_blocks]: Corrupted block!\n");
+		return ok;
+	}
+}
+
+#endif
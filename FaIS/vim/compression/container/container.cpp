@@ -0,0 +1,85 @@
+#include "container.h"
+#include <fcntl.h>
+#include <string.h>
+#include <sstream>
+
+using namespace std;
+using namespace container;
+
+// "-" stands for the standard input/output
+int open_file(const char* path, bool output){
+	if(!strcmp(path, "-"))
+		return output ? STDOUT_FILENO : STDIN_FILENO;
+	return output ? open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644) : open(path, O_RDONLY);
+}
+
+int main(int argc, const char** argv){
+	const string mode = argc > 1 ? argv[1] : "";
+	if(mode == "-c" && argc == 5){
+		// -c <codec,...> <input> <output>: every block keeps the smallest of the codecs
+		vector<pipeline::codec_id_t> codecs;
+		stringstream ss(argv[2]);
+		for(string name; getline(ss, name, ','); ){
+			auto codec = pipeline::make_codec(name);
+			if(!codec){
+				fprintf(stderr, "ERROR: Unknown codec %s!\n", name.c_str());
+				return 1;
+			}
+			codecs.push_back(codec->id());
+		}
+
+		int fd_in = open_file(argv[3], false), fd_out = open_file(argv[4], true);
+		if(fd_in < 0 || fd_out < 0){
+			fprintf(stderr, "ERROR: Unable to open %s!\n", fd_in < 0 ? argv[3] : argv[4]);
+			return 1;
+		}
+		bool ok = compress(fd_in, fd_out, codecs);
+		close(fd_in);
+		close(fd_out);
+		return !ok;
+	} else if(mode == "-d" && argc == 4){
+		// -d <container> <output>
+		int fd_in = open(argv[2], O_RDONLY), fd_out = open_file(argv[3], true);
+		if(fd_in < 0 || fd_out < 0){
+			fprintf(stderr, "ERROR: Unable to open %s!\n", fd_in < 0 ? argv[2] : argv[3]);
+			return 1;
+		}
+		bool ok = Reader(fd_in).decompress(fd_out);
+		close(fd_in);
+		close(fd_out);
+		return !ok;
+	} else if(mode == "-x" && argc == 5){
+		// -x <offset> <count> <container>: the raw bytes [offset, offset+count) to the standard output
+		int fd = open(argv[4], O_RDONLY);
+		Reader reader(fd);
+		if(fd < 0 || !reader.valid()){
+			fprintf(stderr, "ERROR: Unable to open %s!\n", argv[4]);
+			return 1;
+		}
+		vector<uint8_t> out(strtoull(argv[3], nullptr, 10));
+		size_t size = reader.read(strtoull(argv[2], nullptr, 10), out.data(), out.size());
+		bool ok = size != SIZE_MAX && write_all(STDOUT_FILENO, out.data(), size);
+		close(fd);
+		return !ok;
+	} else if(mode == "-l" && argc == 3){
+		// -l <container>: one line per block
+		int fd = open(argv[2], O_RDONLY);
+		Reader reader(fd);
+		if(fd < 0 || !reader.valid()){
+			fprintf(stderr, "ERROR: Unable to open %s!\n", argv[2]);
+			return 1;
+		}
+		for(size_t i=0; i<reader.block_count(); ++i){
+			const record_t& record = reader.record(i);
+			printf("%zu\t%s\t%u -> %u\t%08x\n", i, pipeline::make_codec(record.codec) ?
+				pipeline::make_codec(record.codec)->name() : "?", record.raw_size, record.stored_size, record.checksum);
+		}
+		close(fd);
+		return 0;
+	}
+
+	fprintf(stderr, "Usage: %s -c <codec,...> <input> <output> | -d <container> <output> | "
+		"-x <offset> <count> <container> | -l <container>\n", argv[0]);
+	fprintf(stderr, "Codecs: raw, huffman, lzw, lz77, bwt, fse\n");
+	return 1;
+}
@@ -0,0 +1,337 @@
+
+#ifndef _CONTAINER_
+#define _CONTAINER_
+
+#include "../pipeline/pipeline.h"
+
+
+namespace container{
+	using pipeline::block_t;
+	using pipeline::codec_id_t;
+
+	static const size_t BLOCK_SIZE = 1 << 20;
+	static const char MAGIC[4] = { 'S', 'E', 'E', 'K' };
+	static const uint8_t VERSION = 1;
+
+	static const size_t HEADER_SIZE = sizeof(MAGIC) + 1 + 4;
+	static const size_t RECORD_SIZE = 1 + 4 + 4 + 4;
+	static const size_t INDEX_ENTRY_SIZE = 8 + RECORD_SIZE;
+	static const size_t FOOTER_SIZE = 8 + 4 + sizeof(MAGIC);
+
+	/* Container format
+	 *
+	 * 	header blocks index footer
+	 * 	header	- "SEEK", version (u8), block size (u32)
+	 * 	block	- record, stored bytes
+	 * 	record	- codec id (u8), raw size (u32), stored size (u32), CRC-32 of the raw bytes (u32)
+	 * 	index	- offset of the block in the file (u64) and its record, for every block
+	 * 	footer	- offset of the index (u64), block count (u32), "SEEK"
+	 *
+	 * Integers are big-endian. Every block is coded on its own by the codec
+	 * its id names (see pipeline::make_codec), so reaching any offset costs
+	 * one footer read, one index read and a single block to decode, and
+	 * blocks are coded in parallel in both directions. The records in front
+	 * of the blocks duplicate the index so a damaged file can be scanned.
+	 */
+
+	// CRC-32 (IEEE 802.3, reflected), continuing from `crc`
+	inline uint32_t crc32(const uint8_t* src, size_t size, uint32_t crc=0){
+		static const std::array<uint32_t, 256> table = [](){
+			std::array<uint32_t, 256> table;
+			for(uint32_t i=0; i<256; ++i){
+				uint32_t value = i;
+				for(size_t bit=0; bit<8; ++bit)
+					value = value & 1 ? 0xedb88320u ^ (value >> 1) : value >> 1;
+				table[i] = value;
+			}
+			return table;
+		}();
+
+		crc = ~crc;
+		for(size_t i=0; i<size; ++i)
+			crc = table[(crc ^ src[i]) & 0xff] ^ (crc >> 8);
+		return ~crc;
+	}
+
+	struct record_t{
+		uint8_t codec;
+		uint32_t raw_size;
+		uint32_t stored_size;
+		uint32_t checksum;
+		uint64_t offset;		// of the block in the file (index only)
+		uint64_t raw_offset;	// of the raw bytes in the whole input (computed)
+	};
+
+	inline void put_record(block_t& out, const record_t& record){
+		out.push_back(record.codec);
+		put_u32(out, record.raw_size);
+		put_u32(out, record.stored_size);
+		put_u32(out, record.checksum);
+	}
+
+	inline record_t get_record(const uint8_t* src){
+		return record_t{src[0], get_u32(src+1), get_u32(src+5), get_u32(src+9), 0, 0};
+	}
+
+	// reads exactly `size` bytes at `offset`
+	inline bool read_at(int fd, void* dest, size_t size, uint64_t offset){
+		size_t total = 0;
+		while(total < size){
+			ssize_t n = pread(fd, static_cast<uint8_t*>(dest) + total, size - total, offset + total);
+			if(n < 0 && errno == EINTR)
+				continue;
+			if(n <= 0)
+				return false;
+			total += n;
+		}
+		return true;
+	}
+
+	/* Args:
+	 * 	src		- raw bytes of a block
+	 * 	codecs	- candidate codecs
+	 * 	record	- filled with everything but the offsets
+	 * 	out		- stored bytes
+	 *
+	 * Keeps the smallest output among the candidates, or the raw bytes
+	 * if none of them makes the block smaller.
+	 */
+	inline bool encode_block(const block_t& src, const std::vector<codec_id_t>& codecs, record_t& record, block_t& out){
+		record = record_t{pipeline::RAW, static_cast<uint32_t>(src.size()), static_cast<uint32_t>(src.size()),
+			crc32(src.data(), src.size()), 0, 0};
+		out = src;
+		block_t tmp;
+		for(const auto& id: codecs){
+			auto codec = pipeline::make_codec(id);
+			if(!codec || !codec->encode(src, tmp))
+				return false;
+			if(tmp.size() < out.size()){
+				out.swap(tmp);
+				record.codec = id;
+				record.stored_size = out.size();
+			}
+		}
+		return true;
+	}
+
+	// decodes and verifies the stored bytes of a block
+	inline bool decode_block(const block_t& src, const record_t& record, block_t& out){
+		auto codec = pipeline::make_codec(record.codec);
+		if(!codec || !codec->decode(src, out) || out.size() != record.raw_size ||
+				crc32(out.data(), out.size()) != record.checksum){
+			fprintf(stderr, "WARNING[container::decode_block]: Corrupted block at %llu!\n",
+				static_cast<unsigned long long>(record.offset));
+			return false;
+		}
+		return true;
+	}
+
+	/* Args:
+	 * 	fd_in			- file descriptor to read the raw bytes from
+	 * 	fd_out			- file descriptor to write the container to
+	 * 	codecs			- candidate codecs of every block (see encode_block)
+	 * 	block_size		- raw bytes per block
+	 * 	thread_count	- maximum number of worker threads (0: one per core)
+	 *
+	 * 	Input is read `thread_count` blocks at a time, so memory stays
+	 * 	bounded. Returns false on an I/O error
+	 */
+	inline bool compress(int fd_in, int fd_out, const std::vector<codec_id_t>& codecs={pipeline::HUFFMAN, pipeline::LZW},
+			size_t block_size=BLOCK_SIZE, size_t thread_count=0){
+		if(!block_size || block_size > UINT32_MAX)
+			block_size = BLOCK_SIZE;
+		if(!thread_count)
+			thread_count = std::max(1u, std::thread::hardware_concurrency());
+
+		block_t header(MAGIC, MAGIC+sizeof(MAGIC));
+		header.push_back(VERSION);
+		put_u32(header, block_size);
+		if(!write_all(fd_out, header.data(), header.size()))
+			return false;
+
+		uint64_t offset = header.size();
+		std::vector<record_t> records;
+		std::vector<block_t> raw(thread_count), stored(thread_count);
+		std::vector<record_t> batch(thread_count);
+		bool end = false;
+		while(!end){
+			size_t count = 0;
+			while(count < thread_count && !end){
+				raw[count].resize(block_size);
+				raw[count].resize(read_all(fd_in, raw[count].data(), block_size));
+				end = raw[count].size() < block_size;
+				count += !raw[count].empty();
+			}
+
+			std::atomic<bool> ok(true);
+			parallel_for(count, thread_count, [&](size_t i){
+				if(!encode_block(raw[i], codecs, batch[i], stored[i]))
+					ok = false;
+			});
+			if(!ok)
+				return false;
+
+			for(size_t i=0; i<count; ++i){
+				block_t record;
+				batch[i].offset = offset;
+				put_record(record, batch[i]);
+				if(!write_all(fd_out, record.data(), record.size()) ||
+						!write_all(fd_out, stored[i].data(), stored[i].size()))
+					return false;
+				offset += record.size() + stored[i].size();
+				records.push_back(batch[i]);
+			}
+		}
+
+		block_t index;
+		for(const auto& record: records){
+			put_u64(index, record.offset);
+			put_record(index, record);
+		}
+		put_u64(index, offset);
+		put_u32(index, records.size());
+		index.insert(index.end(), MAGIC, MAGIC+sizeof(MAGIC));
+		return write_all(fd_out, index.data(), index.size());
+	}
+
+	/* Reader class
+	 *
+	 * Random access to a container through a seekable file descriptor:
+	 * opening reads the footer and the index, read() decodes the blocks
+	 * covering the requested range only, keeping the last one decoded.
+	 */
+	class Reader{
+		private:
+		int m_fd;
+		size_t m_block_size;
+		uint64_t m_size;
+		std::vector<record_t> m_records;
+		// last block decoded, SIZE_MAX if none
+		size_t m_cached;
+		block_t m_cache;
+
+		public:
+		explicit Reader(int fd): m_fd(fd), m_block_size(0), m_size(0), m_cached(SIZE_MAX){
+			uint8_t header[HEADER_SIZE], footer[FOOTER_SIZE];
+			off_t file_size = lseek(fd, 0, SEEK_END);
+			if(file_size < static_cast<off_t>(HEADER_SIZE + FOOTER_SIZE) || !read_at(fd, header, HEADER_SIZE, 0) ||
+					!read_at(fd, footer, FOOTER_SIZE, file_size - FOOTER_SIZE) ||
+					!std::equal(MAGIC, MAGIC+sizeof(MAGIC), reinterpret_cast<const char*>(header)) ||
+					!std::equal(MAGIC, MAGIC+sizeof(MAGIC), reinterpret_cast<const char*>(footer + 12)) ||
+					header[4] != VERSION){
+				fprintf(stderr, "WARNING[container::Reader]: Not a container!\n");
+				return;
+			}
+
+			uint64_t index_offset = get_u64(footer);
+			size_t count = get_u32(footer + 8);
+			if(index_offset + count * INDEX_ENTRY_SIZE != file_size - FOOTER_SIZE){
+				fprintf(stderr, "WARNING[container::Reader]: Corrupted index!\n");
+				return;
+			}
+			block_t index(count * INDEX_ENTRY_SIZE);
+			if(!read_at(fd, index.data(), index.size(), index_offset)){
+				fprintf(stderr, "WARNING[container::Reader]: Corrupted index!\n");
+				return;
+			}
+
+			m_records.resize(count);
+			uint64_t raw_offset = 0;
+			for(size_t i=0; i<count; ++i){
+				const uint8_t* entry = index.data() + i * INDEX_ENTRY_SIZE;
+				m_records[i] = get_record(entry + 8);
+				m_records[i].offset = get_u64(entry);
+				m_records[i].raw_offset = raw_offset;
+				raw_offset += m_records[i].raw_size;
+				if(m_records[i].offset + RECORD_SIZE + m_records[i].stored_size > index_offset){
+					fprintf(stderr, "WARNING[container::Reader]: Corrupted index!\n");
+					m_records.clear();
+					return;
+				}
+			}
+			m_block_size = get_u32(header + 5);
+			m_size = raw_offset;
+		}
+
+		// false if the container could not be opened
+		inline bool valid() const{ return m_block_size; }
+		// number of raw bytes
+		inline uint64_t size() const{ return m_size; }
+		inline size_t block_count() const{ return m_records.size(); }
+		inline const record_t& record(size_t i) const{ return m_records[i]; }
+
+		// decodes block `i` into `out`
+		inline bool block(size_t i, block_t& out) const{
+			const record_t& record = m_records[i];
+			block_t stored(record.stored_size);
+			if(!read_at(m_fd, stored.data(), stored.size(), record.offset + RECORD_SIZE)){
+				fprintf(stderr, "WARNING[container::Reader]: Truncated block!\n");
+				return false;
+			}
+			return decode_block(stored, record, out);
+		}
+
+		/* Args:
+		 * 	offset	- position in the raw bytes
+		 * 	dest	- where the bytes are copied to
+		 * 	count	- number of bytes
+		 *
+		 * 	Returns the number of bytes read (short at the end), SIZE_MAX on an error
+		 */
+		inline size_t read(uint64_t offset, uint8_t* dest, size_t count){
+			if(offset >= m_size)
+				return 0;
+			count = std::min<uint64_t>(count, m_size - offset);
+
+			// last block starting at or before `offset`
+			size_t i = std::upper_bound(m_records.begin(), m_records.end(), offset,
+				[](uint64_t offset, const record_t& record){ return offset < record.raw_offset; }) - m_records.begin() - 1;
+			size_t done = 0;
+			for(; done<count && i<m_records.size(); ++i){
+				if(m_cached != i){
+					m_cached = SIZE_MAX;
+					if(!block(i, m_cache))
+						return SIZE_MAX;
+					m_cached = i;
+				}
+				size_t from = offset + done - m_records[i].raw_offset;
+				size_t n = std::min<uint64_t>(count - done, m_records[i].raw_size - from);
+				memcpy(dest + done, m_cache.data() + from, n);
+				done += n;
+			}
+			return done;
+		}
+
+		/* Args:
+		 * 	fd_out			- file descriptor to write the raw bytes to
+		 * 	thread_count	- maximum number of worker threads (0: one per core)
+		 *
+		 * 	Returns false on an I/O error or corrupted input
+		 */
+		inline bool decompress(int fd_out, size_t thread_count=0) const{
+			if(!valid())
+				return false;
+			if(!thread_count)
+				thread_count = std::max(1u, std::thread::hardware_concurrency());
+
+			std::vector<block_t> batch(thread_count);
+			for(size_t first=0; first<m_records.size(); first+=thread_count){
+				size_t count = std::min(thread_count, m_records.size() - first);
+				std::atomic<bool> ok(true);
+				parallel_for(count, thread_count, [&](size_t i){
+					if(!block(first + i, batch[i]))
+						ok = false;
+				});
+				if(!ok)
+					return false;
+				for(size_t i=0; i<count; ++i){
+					if(!write_all(fd_out, batch[i].data(), batch[i].size()))
+						return false;
+				}
+			}
+			return true;
+		}
+	};
+}
+
+#endif
@@ -0,0 +1,429 @@
+
+#ifndef _FSE_
+#define _FSE_
+
+#include "../huffman/huffman.h"
+#include "../Bit-Stream/codec_util.h"
+
+
+namespace fse{
+	// states of the coding table are [2^log, 2^(log+1)), 2^log slots in the table
+	static const size_t MIN_TABLE_LOG = 5;
+	static const size_t MAX_TABLE_LOG = 12;
+	static const size_t DEFAULT_TABLE_LOG = 11;
+	static_assert(4 * MAX_TABLE_LOG <= 57, "four transitions must fit in a refilled BitReader");
+	// input bytes per block of the stream format
+	static const size_t BLOCK_SIZE = 1 << 20;
+	static const char MAGIC[4] = { 'F', 'S', 'E', '1' };
+
+	// slots of every byte in the coding table, summing to 2^log
+	using normalized_t = std::array<uint16_t, 256>;
+
+	// position of the highest set bit of `value` (> 0)
+	inline size_t high_bit(uint32_t value){
+		return 31 - __builtin_clz(value);
+	}
+
+	/* Args:
+	 * 	counts		- byte frequencies of `size` bytes
+	 * 	size		- number of bytes
+	 * 	table_log	- preferred table size [MIN_TABLE_LOG, MAX_TABLE_LOG]
+	 *
+	 * 	Returns the table log of a block: smaller for short inputs, where
+	 * 	the table would cost more than the precision gains, but large
+	 * 	enough to give every present byte a slot
+	 */
+	inline size_t choose_table_log(const huffman::histogram_t& counts, size_t size, size_t table_log=DEFAULT_TABLE_LOG){
+		table_log = std::max(MIN_TABLE_LOG, std::min(table_log, MAX_TABLE_LOG));
+		if(size > 1)
+			table_log = std::min(table_log, std::max(MIN_TABLE_LOG, high_bit(size - 1) + 2));
+
+		size_t present = std::count_if(counts.begin(), counts.end(), [](size_t count){ return count != 0; });
+		while((static_cast<size_t>(1) << table_log) < present)
+			++table_log;
+		return table_log;
+	}
+
+	/* Scales the frequencies to 2^table_log slots. Every present byte gets
+	 * at least one slot, and the rounding surplus (or deficit) is settled
+	 * one slot at a time where it costs the fewest coded bits.
+	 *
+	 * Args:
+	 * 	counts		- byte frequencies (at least one non-zero, at most
+	 * 				  2^table_log of them)
+	 * 	table_log	- table size
+	 */
+	inline normalized_t normalize(const huffman::histogram_t& counts, size_t table_log){
+		const size_t table_size = static_cast<size_t>(1) << table_log;
+		size_t total = 0;
+		for(const auto& count: counts)
+			total += count;
+
+		normalized_t norm;
+		size_t sum = 0;
+		for(size_t s=0; s<256; ++s){
+			norm[s] = 0;
+			if(counts[s]){
+				norm[s] = std::max<size_t>(1, static_cast<double>(counts[s]) * table_size / total + 0.5);
+				sum += norm[s];
+			}
+		}
+
+		// cost of a byte is -log2(norm / table_size) bits
+		while(sum > table_size){
+			size_t best = 256;
+			double best_cost = 0;
+			for(size_t s=0; s<256; ++s){
+				if(norm[s] > 1){
+					double cost = counts[s] * std::log2(static_cast<double>(norm[s]) / (norm[s] - 1));
+					if(best == 256 || cost < best_cost){
+						best = s;
+						best_cost = cost;
+					}
+				}
+			}
+			--norm[best];
+			--sum;
+		}
+		while(sum < table_size){
+			size_t best = 256;
+			double best_gain = 0;
+			for(size_t s=0; s<256; ++s){
+				if(norm[s]){
+					double gain = counts[s] * std::log2(static_cast<double>(norm[s] + 1) / norm[s]);
+					if(best == 256 || gain > best_gain){
+						best = s;
+						best_gain = gain;
+					}
+				}
+			}
+			++norm[best];
+			++sum;
+		}
+		return norm;
+	}
+
+	/* Args:
+	 * 	norm		- normalized frequencies (summing to 2^table_log)
+	 * 	table_log	- table size
+	 *
+	 * 	Returns the byte of every slot: the slots of a byte are scattered
+	 * 	over the table by an odd step, so each byte's states are spread
+	 * 	evenly instead of sitting in one run
+	 */
+	inline std::vector<uint8_t> spread(const normalized_t& norm, size_t table_log){
+		const size_t table_size = static_cast<size_t>(1) << table_log, mask = table_size - 1;
+		const size_t step = (table_size >> 1) + (table_size >> 3) + 3;
+		std::vector<uint8_t> table(table_size);
+		size_t pos = 0;
+		for(size_t s=0; s<256; ++s){
+			for(size_t k=0; k<norm[s]; ++k){
+				table[pos] = s;
+				pos = (pos + step) & mask;
+			}
+		}
+		return table;
+	}
+
+	/* Encoder class
+	 *
+	 * Coding tables of tANS. Encoding byte s from state x in
+	 * [2^log, 2^(log+1)) first writes the low bits of x until it falls
+	 * into [norm[s], 2*norm[s]), then jumps to the slot of s numbered by
+	 * what is left. A byte of probability p thus costs -log2(p) bits on
+	 * average, fractions of a bit included, for a shift and two lookups.
+	 */
+	class Encoder{
+		private:
+		struct transform_t{
+			int32_t find_state;	// first slot of the byte in m_states, minus its frequency
+			uint32_t bits;		// (max bits << 16) - (smallest state needing them)
+		};
+
+		size_t m_table_log;
+		std::vector<uint16_t> m_states;		// next state, by byte then slot
+		std::array<transform_t, 256> m_transforms;
+
+		public:
+		Encoder(const normalized_t& norm, size_t table_log):
+			m_table_log(table_log), m_states(static_cast<size_t>(1) << table_log) {
+			const size_t table_size = m_states.size();
+			std::array<uint32_t, 256> cumulative;
+			for(size_t s=0, total=0; s<256; total+=norm[s++])
+				cumulative[s] = total;
+
+			auto table = spread(norm, table_log);
+			for(size_t u=0; u<table_size; ++u)
+				m_states[cumulative[table[u]]++] = table_size + u;
+
+			for(size_t s=0, total=0; s<256; ++s){
+				m_transforms[s] = transform_t{0, 0};
+				if(!norm[s])
+					continue;
+				// states >= norm << max_bits shed max_bits bits, the others one less
+				uint32_t max_bits = table_log - (norm[s] > 1 ? high_bit(norm[s] - 1) : 0);
+				m_transforms[s].bits = (max_bits << 16) - (static_cast<uint32_t>(norm[s]) << max_bits);
+				m_transforms[s].find_state = static_cast<int32_t>(total) - norm[s];
+				total += norm[s];
+			}
+		}
+
+		inline size_t table_log() const{ return m_table_log; }
+
+		/* Args:
+		 * 	state	- current state, replaced by the state after `symbol`
+		 * 	symbol	- byte to encode (must have a slot)
+		 *
+		 * 	Returns the bits shed by the state: value << 4 | count
+		 */
+		inline uint32_t encode(uint32_t& state, uint8_t symbol) const{
+			const transform_t& transform = m_transforms[symbol];
+			uint32_t count = (state + transform.bits) >> 16;
+			uint32_t bits = state & ((1u << count) - 1);
+			state = m_states[(state >> count) + transform.find_state];
+			return bits << 4 | count;
+		}
+	};
+
+	/* Decoder class
+	 *
+	 * One entry per state: the decoded byte, and the number of bits to
+	 * read and the base they are added to for the previous state.
+	 */
+	class Decoder{
+		private:
+		struct entry_t{
+			uint16_t base;
+			uint8_t symbol;
+			uint8_t bits;
+		};
+
+		size_t m_table_log;
+		std::vector<entry_t> m_table;
+
+		public:
+		Decoder(const normalized_t& norm, size_t table_log):
+			m_table_log(table_log), m_table(static_cast<size_t>(1) << table_log) {
+			const size_t table_size = m_table.size();
+			std::array<uint32_t, 256> next;
+			for(size_t s=0; s<256; ++s)
+				next[s] = norm[s];
+
+			auto table = spread(norm, table_log);
+			for(size_t u=0; u<table_size; ++u){
+				uint8_t symbol = table[u];
+				uint32_t x = next[symbol]++;
+				uint8_t bits = table_log - high_bit(x);
+				m_table[u] = entry_t{static_cast<uint16_t>((x << bits) - table_size), symbol, bits};
+			}
+		}
+
+		/* Args:
+		 * 	reader	- reader at the initial states of the payload
+		 * 	dest	- buffer for `count` bytes
+		 * 	count	- number of bytes to decode
+		 *
+		 * Two states take turns, so consecutive bytes do not wait on each
+		 * other's table lookup.
+		 */
+		inline void decode(BitReader& reader, uint8_t* dest, size_t count) const{
+			const entry_t* table = m_table.data();
+			size_t state[2] = { reader.get(m_table_log), reader.get(m_table_log) };
+			auto step = [&](size_t k, size_t i){
+				const entry_t& entry = table[state[k]];
+				dest[i] = entry.symbol;
+				// peek(57) keeps the shift defined (and branchless) for 0 bits
+				state[k] = entry.base + (reader.peek(57) >> (57 - entry.bits));
+				reader.skip(entry.bits);
+			};
+
+			size_t i = 0;
+			for(; i+4<=count; i+=4){
+				reader.refill();
+				step(0, i);
+				step(1, i+1);
+				step(0, i+2);
+				step(1, i+3);
+			}
+			for(; i<count; ++i){
+				reader.refill();
+				step(i & 1, i);
+			}
+		}
+	};
+
+	inline void write_norm(BitWriter& writer, const normalized_t& norm, size_t table_log){
+		for(const auto& slots: norm)
+			writer.put_bit(slots != 0);
+		for(const auto& slots: norm){
+			if(slots)
+				writer.put(slots - 1, table_log);
+		}
+	}
+
+	inline bool read_norm(BitReader& reader, normalized_t& norm, size_t table_log){
+		for(auto& slots: norm)
+			slots = reader.get_bit();
+		size_t sum = 0;
+		for(auto& slots: norm){
+			if(slots)
+				sum += slots = reader.get(table_log) + 1;
+		}
+		return sum == (static_cast<size_t>(1) << table_log) && !reader.overrun();
+	}
+
+	/* Args:
+	 * 	src			- input bytes
+	 * 	size		- number of bytes (fits in 32 bits)
+	 * 	out			- buffer the record is appended to
+	 * 	table_log	- preferred table size (see choose_table_log)
+	 *
+	 * 	Record: table log (u8, 0 for an empty block), presence bitmap of the
+	 * 	256 bytes, slots - 1 of every present byte (table log bits each),
+	 * 	the two final states (table log bits each), the bits shed by the
+	 * 	states, padded to a whole byte.
+	 *
+	 * The states encode the input backwards (ANS is last in, first out)
+	 * and their bits are written in reverse, so the decoder reads the
+	 * record front to back like a huffman record.
+	 */
+	inline void encode_block(const uint8_t* src, size_t size, std::vector<uint8_t>& out, size_t table_log=DEFAULT_TABLE_LOG){
+		if(!size){
+			out.push_back(0);
+			return;
+		}
+
+		huffman::histogram_t counts = huffman::histogram(src, size, 1);
+		table_log = choose_table_log(counts, size, table_log);
+		normalized_t norm = normalize(counts, table_log);
+		Encoder encoder(norm, table_log);
+
+		const uint32_t table_size = static_cast<uint32_t>(1) << table_log;
+		uint32_t state[2] = { table_size, table_size };
+		std::vector<uint32_t> shed(size);
+		for(size_t i=size; i--; )
+			shed[i] = encoder.encode(state[i & 1], src[i]);
+
+		out.push_back(table_log);
+		BitWriter writer(out);
+		write_norm(writer, norm, table_log);
+		writer.put(state[0] - table_size, table_log);
+		writer.put(state[1] - table_size, table_log);
+		for(const auto& bits: shed)
+			writer.put(bits >> 4, bits & 15);
+		writer.flush();
+	}
+
+	/* Args:
+	 * 	reader	- reader at the start of a record written by encode_block
+	 * 	dest	- buffer for the `count` raw bytes of the block
+	 *
+	 * 	Returns false if the record is corrupted
+	 */
+	inline bool decode_block(BitReader& reader, uint8_t* dest, size_t count){
+		size_t table_log = reader.get(8);
+		if(!table_log)
+			return !count && !reader.overrun();
+		if(table_log < MIN_TABLE_LOG || table_log > MAX_TABLE_LOG)
+			return false;
+
+		normalized_t norm;
+		if(!read_norm(reader, norm, table_log))
+			return false;
+
+		Decoder(norm, table_log).decode(reader, dest, count);
+		return !reader.overrun();
+	}
+
+	inline bool decode_block(const uint8_t* src, size_t size, uint8_t* dest, size_t count){
+		BitReader reader(src, size);
+		return decode_block(reader, dest, count);
+	}
+
+	/* Stream format
+	 *
+	 * 	"FSE1" block* end
+	 * 	block	- raw size (u32), record size (u32), record (see encode_block)
+	 * 	end		- raw size 0
+	 *
+	 * Integers are big-endian, as in the huffman stream format.
+	 */
+
+	/* Args:
+	 * 	fd_in		- file descriptor to read the raw bytes from
+	 * 	fd_out		- file descriptor to write the stream format to
+	 * 	block_size	- input bytes per block
+	 * 	table_log	- preferred table size (see choose_table_log)
+	 *
+	 * 	Returns false on an I/O error
+	 */
+	inline bool compress(int fd_in, int fd_out, size_t block_size=BLOCK_SIZE, size_t table_log=DEFAULT_TABLE_LOG){
+		if(!block_size || block_size > UINT32_MAX)
+			block_size = BLOCK_SIZE;
+
+		std::vector<uint8_t> in(block_size), out;
+		if(!write_all(fd_out, MAGIC, sizeof(MAGIC)))
+			return false;
+
+		size_t size;
+		while((size = read_all(fd_in, in.data(), block_size))){
+			out.clear();
+			put_u32(out, size);
+			put_u32(out, 0);
+			encode_block(in.data(), size, out, table_log);
+
+			uint32_t record_size = out.size() - 8;
+			out[4] = record_size >> 24; out[5] = record_size >> 16;
+			out[6] = record_size >> 8; out[7] = record_size;
+			if(!write_all(fd_out, out.data(), out.size()))
+				return false;
+		}
+
+		out.clear();
+		put_u32(out, 0);
+		return write_all(fd_out, out.data(), out.size());
+	}
+
+	/* Args:
+	 * 	fd_in	- file descriptor to read the stream format from
+	 * 	fd_out	- file descriptor to write the raw bytes to
+	 *
+	 * 	Returns false on an I/O error or a corrupted stream
+	 */
+	inline bool decompress(int fd_in, int fd_out){
+		uint8_t header[8];
+		if(read_all(fd_in, header, sizeof(MAGIC)) != sizeof(MAGIC) ||
+				!std::equal(MAGIC, MAGIC+sizeof(MAGIC), reinterpret_cast<const char*>(header))){
+			fprintf(stderr, "WARNING[fse::decompress]: Not an fse stream!\n");
+			return false;
+		}
+
+		std::vector<uint8_t> in, out;
+		while(true){
+			if(read_all(fd_in, header, 4) != 4)
+				break;
+			uint32_t size = get_u32(header);
+			if(!size)
+				return true;
+			if(read_all(fd_in, header+4, 4) != 4)
+				break;
+			uint32_t record_size = get_u32(header+4);
+
+			in.resize(record_size);
+			out.resize(size);
+			if(read_all(fd_in, in.data(), record_size) != record_size)
+				break;
+			if(!decode_block(in.data(), record_size, out.data(), size)){
+				fprintf(stderr, "WARNING[fse::decompress]: Corrupted block!\n");
+				return false;
+			}
+			if(!write_all(fd_out, out.data(), size))
+				return false;
+		}
+
+		fprintf(stderr, "WARNING[fse::decompress]: Unexpected end of stream!\n");
+		return false;
+	}
+}
+
+#endif
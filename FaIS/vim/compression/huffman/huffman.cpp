@@ -1,9 +1,47 @@
+
 #include "huffman.h"
+#include <fcntl.h>
+#include <string.h>
 
 using namespace std;
 using namespace huffman;
 
+// "-" stands for the standard input/output
+int open_file(const char* path, bool output){
+	if(!strcmp(path, "-"))
+		return output ? STDOUT_FILENO : STDIN_FILENO;
+	return output ? open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644) : open(path, O_RDONLY);
+}
+
 int main(int argc, const char** argv){
+	// -c/-d: block mode, -c1: order-1 block mode, -ca/-da: adaptive (single-pass) mode
+	const string mode = argc == 4 ? argv[1] : "";
+	if(mode == "-c" || mode == "-c1" || mode == "-d" || mode == "-ca" || mode == "-da"){
+		int fd_in = open_file(argv[2], false), fd_out = open_file(argv[3], true);
+		if(fd_in < 0 || fd_out < 0){
+			fprintf(stderr, "ERROR: Unable to open %s!\n", fd_in < 0 ? argv[2] : argv[3]);
+			return 1;
+		}
+
+		bool ok;
+		if(mode == "-c")
+			ok = compress(fd_in, fd_out);
+		else if(mode == "-c1")
+			ok = compress(fd_in, fd_out, BLOCK_SIZE, MAX_CODE_LENGTH, true, 16);
+		else if(mode == "-d")
+			ok = decompress(fd_in, fd_out);
+		else if(mode == "-ca")
+			ok = compress_adaptive(fd_in, fd_out);
+		else
+			ok = decompress_adaptive(fd_in, fd_out);
+		close(fd_in);
+		close(fd_out);
+		return !ok;
+	} else if(argc > 2){
+		fprintf(stderr, "Usage: %s [text] | -c[1|a] <input> <output> | -d[a] <input> <output>\n", argv[0]);
+		return 1;
+	}
+
 	string text = "hello, my name is world and this is an example of huffman compression.";
 	if(argc == 2) text = string(argv[1]);
 	printf("Original:   %s\n", text.c_str());
@@ -1,143 +1,1322 @@
-
 #pragma once
 
 #include <algorithm>
+#include <array>
 #include <cmath>
-#include <map>
-#include <queue>
 #include <vector>
 #include <string>
+#include <thread>
+#include <atomic>
 #include <cstdio>
 #include <cstdlib>
-#include "bit_stream.h"
+#include <cstring>
+#include "../Bit-Stream/bit_io.h"
+#include "../Bit-Stream/codec_util.h"
 
 
 namespace huffman{
+	// longest code the builder emits by default and the decoder accepts
+	static const size_t MAX_CODE_LENGTH = 20;
+	// bits resolved by the first decoding table probe
+	static const size_t PRIMARY_BITS = 10;
+	static_assert(2 * MAX_CODE_LENGTH <= 57, "two codes must fit in a refilled BitReader");
+	// input bytes per block of the stream format
+	static const size_t BLOCK_SIZE = 1 << 20;
+	static const char MAGIC[4] = { 'H', 'U', 'F', '1' };
+	// minimum input bytes per counting thread
+	static const size_t PARALLEL_THRESHOLD = 1 << 20;
+	static const char BLOCKS_MAGIC[4] = { 'H', 'U', 'F', 'P' };
+	static const char ADAPTIVE_MAGIC[4] = { 'H', 'U', 'F', 'A' };
+	// bytes read per call in the adaptive (single-pass) mode
+	static const size_t ADAPTIVE_CHUNK = 1 << 16;
+	// most code tables an order-1 block may use
+	static const size_t MAX_CONTEXT_TABLES = 32;
+
 	using compressed_data_t = std::pair<std::vector<unsigned char> /* data */, size_t /* offset */>;
 	using encoded_data_t = compressed_data_t;
-	using table_t = std::map<char, std::vector<bool>>;
+	// code length of every byte value (0 if the byte does not occur)
+	using table_t = std::array<uint8_t, 256>;
+
+	struct code_t{
+		uint32_t bits;
+		uint8_t length;
+	};
+	using codes_t = std::array<code_t, 256>;
+	// occurrences of every byte value
+	using histogram_t = std::array<size_t, 256>;
 
 	struct Node{
-		char c;
 		size_t freq;
-		Node *left, *right;
-		Node *top;
+		uint16_t parent;	// index of the parent in the node array
+		uint8_t symbol;		// only for leaves
+	};
 
-		Node(char c_=0, size_t freq_=0, Node* left_=nullptr, Node* right_=nullptr, Node* top_=nullptr): 
-			c(c_), freq(freq_), left(left_), right(right_), top(top_) {}
-		~Node(){
-			if(!left)
-				delete left;
-			if(!right)
-				delete right;
+	/* Shortens the codes longer than `max_length` and then pays the Kraft
+	 * inequality back by lengthening the longest codes below the limit.
+	 */
+	inline void limit_lengths(table_t& lengths, size_t max_length){
+		const uint64_t one = static_cast<uint64_t>(1) << max_length;
+		uint64_t kraft = 0;
+		for(auto& length: lengths){
+			if(length > max_length)
+				length = max_length;
+			if(length)
+				kraft += one >> length;
 		}
-	};
 
-	std::pair<compressed_data_t, table_t> compress(const std::string& data){
-		using pair_t = std::pair<char, size_t>;
+		while(kraft > one){
+			size_t longest = lengths.size();
+			for(size_t i=0; i<lengths.size(); ++i){
+				if(lengths[i] && lengths[i] < max_length && 
+						(longest == lengths.size() || lengths[i] > lengths[longest]))
+					longest = i;
+			}
+			kraft -= one >> (lengths[longest] + 1);
+			++lengths[longest];
+		}
+	}
 
-		compressed_data_t out;
-		std::vector<pair_t> vp;
-		std::map<char, size_t> mp;
+	/* Assigns canonical codes: shorter codes first, codes of the same
+	 * length in increasing byte order. Only the lengths need to be stored.
+	 */
+	inline codes_t canonical_codes(const table_t& lengths){
+		codes_t codes;
+		size_t count[MAX_CODE_LENGTH+1] = { 0 };
+		uint32_t next[MAX_CODE_LENGTH+1] = { 0 };
 
-		// printf("Initializing...\n");
-		// Obtaining frequencies for each occuring character
-		for(const auto& c: data)
-			mp[c] += 1;
-
-		// Sorting characters according to the frequencies
-		vp.assign(mp.cbegin(), mp.cend());
-		std::sort(vp.begin(), vp.end(), 
-				[](const pair_t& p1, const pair_t& p2){
-					return p1.second > p2.second;
-				});
+		for(const auto& length: lengths){
+			if(length)
+				++count[length];
+		}
+		for(size_t length=1, code=0; length<=MAX_CODE_LENGTH; ++length){
+			code = (code + count[length-1]) << 1;
+			next[length] = code;
+		}
+		for(size_t i=0; i<lengths.size(); ++i){
+			codes[i].length = lengths[i];
+			codes[i].bits = lengths[i] ? next[lengths[i]]++ : 0;
+		}
+		return codes;
+	}
+
+	/* Decoder class
+	 *
+	 * Two-level lookup table built from canonical code lengths. The primary
+	 * table is indexed by the next PRIMARY_BITS bits and resolves every
+	 * shorter code at once; longer codes point to a secondary table sized
+	 * for the longest code sharing that prefix.
+	 */
+	class Decoder{
+		struct entry_t{
+			uint32_t value;		// symbol, or the first entry of the secondary table
+			uint8_t length;		// code length (0 if the entry is invalid)
+			uint8_t bits;		// secondary table index width (0 if `value` is a symbol)
+		};
+
+		private:
+		std::vector<entry_t> m_table;
+		bool m_valid;
+
+		public:
+		explicit Decoder(const table_t& lengths): m_table(1 << PRIMARY_BITS, entry_t{0, 0, 0}), m_valid(true){
+			uint64_t kraft = 0;
+			for(const auto& length: lengths){
+				if(length > MAX_CODE_LENGTH){
+					m_valid = false;
+					return;
+				}
+				if(length)
+					kraft += static_cast<uint64_t>(1) << (MAX_CODE_LENGTH - length);
+			}
+			if(kraft > (static_cast<uint64_t>(1) << MAX_CODE_LENGTH)){
+				m_valid = false;
+				return;
+			}
 
-		// Initializing the unit nodes
-		std::vector<Node*> nodes;
-		for(const auto& p: vp)
-			nodes.push_back(new Node(p.first, p.second));
-		std::vector<Node*> nodes_copy = nodes;
+			codes_t codes = canonical_codes(lengths);
+			for(const auto& code: codes){
+				if(code.length > PRIMARY_BITS){
+					auto& entry = m_table[code.bits >> (code.length - PRIMARY_BITS)];
+					if(code.length - PRIMARY_BITS > entry.bits)
+						entry.bits = code.length - PRIMARY_BITS;
+				}
+			}
+			for(size_t i=0; i<(1 << PRIMARY_BITS); ++i){
+				if(m_table[i].bits){
+					m_table[i].value = m_table.size();
+					m_table.resize(m_table.size() + (1 << m_table[i].bits), entry_t{0, 0, 0});
+				}
+			}
 
-		// Obtaining the Huffman Tree
-		// printf("Obtaining Huffman Tree...\n");
-		while(nodes.size() > 1){
-			Node* node1 = nodes.back();
-			nodes.pop_back();
+			for(size_t symbol=0; symbol<codes.size(); ++symbol){
+				const auto& code = codes[symbol];
+				size_t first, count;
+				if(!code.length){
+					continue;
+				} else if(code.length <= PRIMARY_BITS){
+					first = code.bits << (PRIMARY_BITS - code.length);
+					count = 1 << (PRIMARY_BITS - code.length);
+				} else{
+					size_t rest = code.length - PRIMARY_BITS;
+					const auto& entry = m_table[code.bits >> rest];
+					first = entry.value + ((code.bits & ((1 << rest) - 1)) << (entry.bits - rest));
+					count = 1 << (entry.bits - rest);
+				}
+				for(size_t i=0; i<count; ++i)
+					m_table[first+i] = entry_t{static_cast<uint32_t>(symbol), code.length, 0};
+			}
+		}
 
-			Node* node2 = nodes.back();
-			nodes.pop_back();
+		inline bool valid() const{ return m_valid; }
 
-			Node* node = new Node(0, node2->freq + node1->freq, node2, node1);
-			node1->top = node2->top = node;
+		// decodes the next symbol; returns -1 on an invalid code
+		inline int decode(BitReader& in) const{
+			in.refill();
+			return lookup(in);
+		}
 
-			for(size_t i=0; i<nodes.size(); ++i){
-				if(node->freq > nodes[i]->freq){
-					nodes.insert(nodes.begin()+i, node);
+		/* Args:
+		 * 	in		- reader positioned at the first code
+		 * 	dest	- buffer for at least `count` symbols
+		 * 	count	- number of symbols to decode
+		 *
+		 * 	Returns the number of symbols decoded (less than `count` on an invalid code)
+		 */
+		inline size_t decode(BitReader& in, uint8_t* dest, size_t count) const{
+			size_t i = 0;
+			int s0, s1;
+			// the reader holds at least 57 bits after a refill: two codes
+			for(; i+2<=count; i+=2){
+				in.refill();
+				if((s0 = lookup(in)) < 0 || (s1 = lookup(in)) < 0)
 					break;
-				}
-				if(i+1 == nodes.size()){
-					nodes.push_back(node);
+				dest[i] = s0;
+				dest[i+1] = s1;
+			}
+			for(; i<count; ++i){
+				if((s0 = decode(in)) < 0)
 					break;
+				dest[i] = s0;
+			}
+			return i;
+		}
+
+		/* Args:
+		 * 	in		- readers of the 4 substreams
+		 * 	dest	- buffer for at least `count` symbols
+		 * 	count	- number of symbols; substream k holds the k-th quarter
+		 * 			  (see segment) of them
+		 *
+		 * 	The four codes of one step do not depend on each other, so the
+		 * 	CPU overlaps their table probes.
+		 *
+		 * 	Returns false on an invalid code
+		 */
+		inline bool decode(BitReader* in, uint8_t* dest, size_t count) const{
+			size_t length = (count + 3) / 4, last = count - std::min(count, 3 * length);
+			uint8_t* d[4] = { dest, dest + std::min(count, length), dest + std::min(count, 2 * length), dest + std::min(count, 3 * length) };
+
+			size_t i = 0;
+			for(; i+2<=last; i+=2){
+				in[0].refill(); in[1].refill(); in[2].refill(); in[3].refill();
+				int s0 = lookup(in[0]), s1 = lookup(in[1]), s2 = lookup(in[2]), s3 = lookup(in[3]);
+				int s4 = lookup(in[0]), s5 = lookup(in[1]), s6 = lookup(in[2]), s7 = lookup(in[3]);
+				if((s0 | s1 | s2 | s3 | s4 | s5 | s6 | s7) < 0)
+					return false;
+				d[0][i] = s0; d[1][i] = s1; d[2][i] = s2; d[3][i] = s3;
+				d[0][i+1] = s4; d[1][i+1] = s5; d[2][i+1] = s6; d[3][i+1] = s7;
+			}
+
+			// the last substream is the shortest one
+			for(size_t k=0; k<4; ++k){
+				size_t n = (k < 3 ? std::min(length, count - std::min(count, k * length)) : last) - i;
+				if(decode(in[k], d[k] + i, n) != n)
+					return false;
+			}
+			return true;
+		}
+
+		// decode without refilling: enough for two codes after a refill
+		inline int lookup(BitReader& in) const{
+			const entry_t* entry = &m_table[in.peek(PRIMARY_BITS)];
+			if(entry->bits)
+				entry = &m_table[entry->value + (in.peek(PRIMARY_BITS + entry->bits) & ((1 << entry->bits) - 1))];
+			if(!entry->length)
+				return -1;
+			in.skip(entry->length);
+			return entry->value;
+		}
+	};
+
+	/* Package-merge: optimal code lengths no longer than `max_length` for
+	 * the `n` leaves of `nodes` sorted by increasing frequency. Every level
+	 * merges the leaves with the pairs (packages) of the level below; the
+	 * length of a symbol is the number of times its leaf occurs in the
+	 * 2n-2 lightest items of the last level.
+	 */
+	inline void package_merge(const Node* nodes, size_t n, size_t max_length, table_t& lengths){
+		struct item_t{
+			size_t weight;
+			int32_t first, second;	// items of the level below, or (-1, leaf)
+		};
+
+		std::vector<std::vector<item_t>> levels(max_length);
+		for(size_t level=0; level<max_length; ++level){
+			auto& items = levels[level];
+			const auto* below = level ? &levels[level-1] : nullptr;
+			size_t leaf = 0, package = 0, package_count = below ? below->size() / 2 : 0;
+			items.reserve(n + package_count);
+
+			while(leaf < n || package < package_count){
+				if(package == package_count || 
+						(leaf < n && nodes[leaf].freq <= (*below)[2*package].weight + (*below)[2*package+1].weight)){
+					items.push_back(item_t{nodes[leaf].freq, -1, static_cast<int32_t>(leaf)});
+					++leaf;
+				} else{
+					items.push_back(item_t{(*below)[2*package].weight + (*below)[2*package+1].weight, 
+							static_cast<int32_t>(2*package), static_cast<int32_t>(2*package+1)});
+					++package;
 				}
 			}
-			if(nodes.empty())
-				nodes.push_back(node);
 		}
 
-		// Obtaining the lookup table
-		// printf("Obtaining lookup table...\n");
-		table_t table;
+		std::array<uint8_t, 256> depth;
+		depth.fill(0);
+		std::vector<std::pair<size_t, int32_t>> stack;
+		for(size_t i=0; i<2*n-2; ++i)
+			stack.emplace_back(max_length-1, i);
+		while(!stack.empty()){
+			auto top = stack.back();
+			stack.pop_back();
+			const auto& item = levels[top.first][top.second];
+			if(item.first < 0){
+				++depth[item.second];
+			} else{
+				stack.emplace_back(top.first-1, item.first);
+				stack.emplace_back(top.first-1, item.second);
+			}
+		}
+		for(size_t i=0; i<n; ++i)
+			lengths[nodes[i].symbol] = depth[i];
+	}
+
+	/* Builds the Huffman tree with the two-queue method and returns the
+	 * code length of every byte. The tree lives in one flat array: the
+	 * leaves sorted by frequency first, then the internal nodes in the
+	 * (non-decreasing frequency) order they are merged, so the two
+	 * lightest nodes are always at the front of one of the two queues and
+	 * every parent comes after its children.
+	 *
+	 * Args:
+	 * 	counts		- byte frequencies
+	 * 	max_length	- longest code allowed [8, MAX_CODE_LENGTH]
+	 * 	optimal		- limits the lengths with package-merge if the tree is
+	 * 				  too deep, otherwise with the faster limit_lengths heuristic
+	 */
+	inline table_t build_lengths(const histogram_t& counts, size_t max_length=MAX_CODE_LENGTH, bool optimal=true){
+		if(max_length < 8)
+			max_length = 8;
+		if(max_length > MAX_CODE_LENGTH)
+			max_length = MAX_CODE_LENGTH;
+
+		table_t lengths;
+		lengths.fill(0);
+
+		std::array<Node, 2*256-1> nodes;
+		size_t n = 0;
+		for(size_t i=0; i<counts.size(); ++i){
+			if(counts[i])
+				nodes[n++] = Node{counts[i], 0, static_cast<uint8_t>(i)};
+		}
+		if(n < 2){
+			// a lone symbol still needs a (1-bit) code
+			if(n) lengths[nodes[0].symbol] = 1;
+			return lengths;
+		}
+		std::sort(nodes.begin(), nodes.begin()+n, 
+				[](const Node& n1, const Node& n2){
+					return n1.freq < n2.freq || (n1.freq == n2.freq && n1.symbol < n2.symbol);
+				});
+
+		size_t leaf = 0, internal = n, end = n, root = 2 * n - 2;
+		auto pop = [&]() -> size_t{
+			if(leaf < n && (internal == end || nodes[leaf].freq <= nodes[internal].freq))
+				return leaf++;
+			return internal++;
+		};
+		while(end <= root){
+			size_t i1 = pop(), i2 = pop();
+			nodes[end] = Node{nodes[i1].freq + nodes[i2].freq, 0, 0};
+			nodes[i1].parent = nodes[i2].parent = end;
+			++end;
+		}
+
+		// parents come after their children: one backward pass gives the depths
+		std::array<uint8_t, 2*256-1> depth;
+		depth[root] = 0;
+		for(size_t i=root; i--; )
+			depth[i] = depth[nodes[i].parent] + 1;
+		size_t longest = 0;
+		for(size_t i=0; i<n; ++i){
+			lengths[nodes[i].symbol] = depth[i];
+			longest = std::max<size_t>(longest, depth[i]);
+		}
+
+		if(longest > max_length){
+			if(optimal)
+				package_merge(nodes.data(), n, max_length, lengths);
+			else
+				limit_lengths(lengths, max_length);
+		}
+		return lengths;
+	}
+
+	/* Adds the byte frequencies of `src` to `counts`. Consecutive bytes go
+	 * to 4 interleaved sub-histograms, so runs of the same byte do not
+	 * serialize on one counter's store-to-load forwarding.
+	 */
+	inline void count(const uint8_t* src, size_t size, histogram_t& counts){
+		// 32-bit lanes keep the sub-histograms in 4 KB; flushed every 1 GB
+		const size_t CHUNK = 1 << 30;
+		uint32_t lanes[4][256];
 
-		for(auto node: nodes_copy){
-			std::vector<bool> bits;
-			auto curr = node;
-			while(curr->top){
-				bits.push_back(curr->top->right == curr);
-				curr = curr->top;
+		for(size_t begin=0; begin<size; begin+=CHUNK){
+			size_t end = size - begin > CHUNK ? begin + CHUNK : size, i = begin;
+			memset(lanes, 0, sizeof(lanes));
+
+			for(; i+8<=end; i+=8){
+				uint64_t word;
+				memcpy(&word, src+i, 8);
+				++lanes[0][word & 0xff];
+				++lanes[1][(word >> 8) & 0xff];
+				++lanes[2][(word >> 16) & 0xff];
+				++lanes[3][(word >> 24) & 0xff];
+				++lanes[0][(word >> 32) & 0xff];
+				++lanes[1][(word >> 40) & 0xff];
+				++lanes[2][(word >> 48) & 0xff];
+				++lanes[3][word >> 56];
 			}
-			table[node->c] = std::vector<bool>(bits.crbegin(), bits.crend());
+			for(; i<end; ++i)
+				++lanes[0][src[i]];
+
+			for(size_t j=0; j<256; ++j)
+				counts[j] += lanes[0][j] + lanes[1][j] + lanes[2][j] + lanes[3][j];
+		}
+	}
+
+	/* Args:
+	 * 	src				- input bytes
+	 * 	size			- number of bytes
+	 * 	thread_count	- maximum number of counting threads (0: one per core)
+	 *
+	 * 	Large inputs are split into slices counted on separate threads and
+	 * 	the per-thread histograms are merged at the end.
+	 */
+	inline histogram_t histogram(const uint8_t* src, size_t size, size_t thread_count=0){
+		histogram_t counts;
+		counts.fill(0);
+
+		if(!thread_count)
+			thread_count = std::thread::hardware_concurrency();
+		if(thread_count > size / PARALLEL_THRESHOLD)
+			thread_count = size / PARALLEL_THRESHOLD;
+		if(thread_count < 2){
+			count(src, size, counts);
+			return counts;
+		}
+
+		std::vector<histogram_t> partial(thread_count);
+		std::vector<std::thread> threads;
+		size_t slice = size / thread_count;
+		for(size_t i=0; i<thread_count; ++i){
+			size_t begin = i * slice, end = i+1 == thread_count ? size : begin + slice;
+			partial[i].fill(0);
+			threads.emplace_back(count, src + begin, end - begin, std::ref(partial[i]));
 		}
+		for(size_t i=0; i<thread_count; ++i){
+			threads[i].join();
+			for(size_t j=0; j<256; ++j)
+				counts[j] += partial[i][j];
+		}
+		return counts;
+	}
+
+	inline std::pair<compressed_data_t, table_t> compress(const std::string& data){
+		compressed_data_t out;
+
+		// printf("Initializing...\n");
+		// Obtaining frequencies for each occuring character
+		histogram_t counts = histogram(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+
+		// Obtaining the code lengths
+		// printf("Obtaining code lengths...\n");
+		table_t table = build_lengths(counts);
 
 		// Compressing the data
 		// printf("Compressing the data...\n");
-		BitStream bs;
+		codes_t codes = canonical_codes(table);
+		BitWriter writer(out.first);
 		for(const auto& c: data){
-			for(const bool& bit: table[c])
-				bs.push(bit, bs.end());
+			const auto& code = codes[static_cast<uint8_t>(c)];
+			writer.put(code.bits, code.length);
 		}
-		
-		out.first = bs.buffer();
-		out.second = bs.gap();
+		out.second = writer.flush();
 		
 		return std::make_pair(out, table);
 	}
 
-	std::string decompress(const compressed_data_t& data, const table_t& table){
+	inline std::string decompress(const compressed_data_t& data, const table_t& table){
 		std::string out;
-		std::vector<bool> bits;
-		char c = 0;
-
-		BitStream bs;
-		bs.rassign<unsigned char>(data.first.data(), 8*data.first.size()-data.second, data.second);
-
-		auto it = bs.cbegin();
-		while(it != bs.cend()){
-			std::vector<bool> tmp;
-			while(it != bs.cend()){
-				tmp.push_back(*it);
-				++it;
-				auto it_table = std::find_if(table.cbegin(), table.cend(),
-						[tmp](const std::pair<char, std::vector<bool>>& p){
-							return p.first && tmp == p.second;
-						});
-				if(it_table != table.cend()){
-					out += it_table->first;
+		Decoder decoder(table);
+		if(!decoder.valid()){
+			fprintf(stderr, "WARNING[huffman::decompress]: Invalid code lengths!\n");
+			return out;
+		}
+
+		size_t bit_count = 8 * data.first.size() - data.second;
+		BitReader in(data.first.data(), data.first.size());
+
+		while(in.position() < bit_count){
+			// decode in chunks while no code can run past the end
+			size_t count = (bit_count - in.position()) / MAX_CODE_LENGTH;
+
+			if(count){
+				size_t size = out.size();
+				out.resize(size + count);
+				size_t n = decoder.decode(in, reinterpret_cast<uint8_t*>(&out[size]), count);
+				out.resize(size + n);
+				if(n < count){
+					fprintf(stderr, "WARNING[huffman::decompress]: Invalid code at bit %zu!\n", in.position());
+					break;
+				}
+			} else{
+				int c = decoder.decode(in);
+				if(c < 0){
+					fprintf(stderr, "WARNING[huffman::decompress]: Invalid code at bit %zu!\n", in.position());
 					break;
 				}
+				out += static_cast<char>(c);
 			}
 		}
 
 		return out;
 	}
-}
 
+	/* Stream format
+	 *
+	 * 	"HUF1" block* end
+	 * 	block	- raw size (u32), record size (u32), record
+	 * 	record	- mode (u8: 1 if interleaved, 2 if order-1, see encode_block),
+	 * 			  presence bitmap of the 256 bytes
+	 * 			  (32 bytes), 5-bit code length of every present byte (padded),
+	 * 			  payload (see encode_payload)
+	 * 	end		- raw size 0
+	 *
+	 * Integers are big-endian. Every block carries its own code lengths, so
+	 * blocks are decoded independently and memory stays bounded by the
+	 * block size.
+	 */
+
+	inline void write_lengths(BitWriter& writer, const table_t& lengths){
+		for(const auto& length: lengths)
+			writer.put_bit(length != 0);
+		for(const auto& length: lengths){
+			if(length)
+				writer.put(length, 5);
+		}
+		writer.flush();
+	}
+
+	inline bool read_lengths(BitReader& reader, table_t& lengths){
+		for(auto& length: lengths)
+			length = reader.get_bit();
+		for(auto& length: lengths){
+			if(length)
+				length = reader.get(5);
+		}
+		// skip the padding
+		reader.get((8 - reader.position() % 8) % 8);
+		return !reader.overrun();
+	}
+
+	inline void encode_symbols(const uint8_t* src, size_t size, const codes_t& codes, BitWriter& writer){
+		for(size_t i=0; i<size; ++i)
+			writer.put(codes[src[i]].bits, codes[src[i]].length);
+	}
+
+	/* Payload of a block: one stream of codes, or (interleaved) the sizes
+	 * of the first 3 substreams (u32 each) followed by the 4 substreams,
+	 * each padded to a whole byte. Substream k encodes the k-th quarter of
+	 * the input (the last one possibly shorter).
+	 */
+	inline void encode_payload(const uint8_t* src, size_t size, const codes_t& codes, 
+			std::vector<uint8_t>& out, bool interleaved){
+		if(!interleaved){
+			BitWriter writer(out);
+			encode_symbols(src, size, codes, writer);
+			writer.flush();
+			return;
+		}
+
+		size_t length = (size + 3) / 4, jump = out.size();
+		out.resize(jump + 12);
+		for(size_t k=0; k<4; ++k){
+			size_t begin = std::min(size, k * length), end = std::min(size, begin + length);
+			size_t start = out.size();
+			BitWriter writer(out);
+			encode_symbols(src + begin, end - begin, codes, writer);
+			writer.flush();
+			if(k < 3){
+				uint32_t bytes = out.size() - start;
+				out[jump+4*k] = bytes >> 24; out[jump+4*k+1] = bytes >> 16;
+				out[jump+4*k+2] = bytes >> 8; out[jump+4*k+3] = bytes;
+			}
+		}
+	}
+
+	/* Args:
+	 * 	reader		- reader at the start of the payload (byte aligned if interleaved)
+	 * 	decoder		- decoder of the block's code lengths
+	 * 	dest		- buffer for the `count` raw bytes of the block
+	 * 	interleaved	- payload layout (see encode_payload)
+	 *
+	 * 	Returns false if the payload is corrupted
+	 */
+	inline bool decode_payload(BitReader& reader, const Decoder& decoder, uint8_t* dest, size_t count, bool interleaved){
+		if(!interleaved)
+			return decoder.decode(reader, dest, count) == count && !reader.overrun();
+
+		size_t pos = reader.position() / 8;
+		if(reader.position() % 8 || pos + 12 > reader.size())
+			return false;
+
+		const uint8_t* jump = reader.data() + pos;
+		size_t sizes[4] = { get_u32(jump), get_u32(jump+4), get_u32(jump+8), 0 };
+		size_t begin = pos + 12, total = sizes[0] + sizes[1] + sizes[2];
+		if(total > reader.size() - begin)
+			return false;
+		sizes[3] = reader.size() - begin - total;
+
+		BitReader in[4] = {
+			BitReader(reader.data() + begin, sizes[0]),
+			BitReader(reader.data() + begin + sizes[0], sizes[1]),
+			BitReader(reader.data() + begin + sizes[0] + sizes[1], sizes[2]),
+			BitReader(reader.data() + begin + total, sizes[3])
+		};
+		return decoder.decode(in, dest, count) && 
+			!in[0].overrun() && !in[1].overrun() && !in[2].overrun() && !in[3].overrun();
+	}
+
+	/* Groups the order-1 contexts (previous bytes) into at most
+	 * `table_count` clusters that share a code table. Seeded with the most
+	 * frequent contexts, every round moves each context to the cluster
+	 * whose (smoothed) statistics code it in the fewest bits.
+	 *
+	 * Args:
+	 * 	counts		- byte frequencies after every previous byte (256 histograms)
+	 * 	table_count	- maximum number of clusters
+	 * 	map			- cluster of every context
+	 * 	clusters	- merged histogram of every cluster
+	 */
+	inline void cluster_contexts(const std::vector<histogram_t>& counts, size_t table_count, 
+			std::array<uint8_t, 256>& map, std::vector<histogram_t>& clusters){
+		const size_t ROUNDS = 4;
+
+		std::vector<size_t> totals(256, 0), order;
+		for(size_t c=0; c<256; ++c){
+			for(const auto& count: counts[c])
+				totals[c] += count;
+			if(totals[c])
+				order.push_back(c);
+		}
+		std::sort(order.begin(), order.end(), 
+				[&](size_t c1, size_t c2){
+					return totals[c1] > totals[c2] || (totals[c1] == totals[c2] && c1 < c2);
+				});
+
+		size_t k = std::max<size_t>(1, std::min(table_count, order.size()));
+		std::vector<int> assignment(256, -1);
+		for(size_t j=0; j<k && j<order.size(); ++j)
+			assignment[order[j]] = j;
+
+		std::vector<std::array<double, 256>> cost(k);
+		for(size_t round=0; round<=ROUNDS; ++round){
+			clusters.assign(k, histogram_t());
+			for(auto& cluster: clusters)
+				cluster.fill(0);
+			for(auto c: order){
+				if(assignment[c] < 0) continue;
+				for(size_t s=0; s<256; ++s)
+					clusters[assignment[c]][s] += counts[c][s];
+			}
+			if(round == ROUNDS)
+				break;
+
+			for(size_t j=0; j<k; ++j){
+				size_t total = 0;
+				for(const auto& count: clusters[j])
+					total += count;
+				for(size_t s=0; s<256; ++s)
+					cost[j][s] = -std::log2((clusters[j][s] + 0.5) / (total + 128.0));
+			}
+
+			bool changed = false;
+			for(auto c: order){
+				int best = 0;
+				double best_cost = 0;
+				for(size_t j=0; j<k; ++j){
+					double bits = 0;
+					for(size_t s=0; s<256; ++s)
+						bits += counts[c][s] * cost[j][s];
+					if(!j || bits < best_cost){
+						best = j;
+						best_cost = bits;
+					}
+				}
+				changed |= assignment[c] != best;
+				assignment[c] = best;
+			}
+			if(!changed)
+				round = ROUNDS - 1;
+		}
+
+		// drop the clusters that lost all their contexts
+		std::vector<int> renumber(k, -1);
+		size_t used = 0;
+		for(size_t j=0; j<k; ++j){
+			bool empty = true;
+			for(const auto& count: clusters[j])
+				empty &= !count;
+			if(!empty || !j){
+				renumber[j] = used;
+				clusters[used++] = clusters[j];
+			}
+		}
+		clusters.resize(used);
+		for(size_t c=0; c<256; ++c)
+			map[c] = assignment[c] < 0 || renumber[assignment[c]] < 0 ? 0 : renumber[assignment[c]];
+	}
+
+	// bits needed to store a cluster number
+	inline size_t context_bits(size_t table_count){
+		size_t bits = 0;
+		while((static_cast<size_t>(1) << bits) < table_count)
+			++bits;
+		return bits;
+	}
+
+	/* Args:
+	 * 	src			- input bytes
+	 * 	size		- number of bytes (fits in 32 bits)
+	 * 	out			- buffer the record is appended to
+	 * 	max_length	- longest code allowed (see build_lengths)
+	 * 	interleaved	- 4 interleaved substreams (see encode_payload)
+	 * 	tables		- order-1 mode with at most this many code tables shared
+	 * 				  by clusters of contexts (0: order-0 mode)
+	 *
+	 * 	Order-1 record: mode 2, table count (u8), cluster of every context
+	 * 	(context_bits each), code lengths of every table, single stream of
+	 * 	codes each chosen by the table of the previous byte (0 at the start).
+	 */
+	inline void encode_block(const uint8_t* src, size_t size, std::vector<uint8_t>& out, 
+			size_t max_length=MAX_CODE_LENGTH, bool interleaved=true, size_t tables=0){
+		if(!tables){
+			table_t lengths = build_lengths(histogram(src, size, 1), max_length);
+			codes_t codes = canonical_codes(lengths);
+
+			out.push_back(interleaved);
+			BitWriter writer(out);
+			write_lengths(writer, lengths);
+			encode_payload(src, size, codes, out, interleaved);
+			return;
+		}
+
+		std::vector<histogram_t> counts(256);
+		for(auto& count: counts)
+			count.fill(0);
+		for(size_t i=0; i<size; ++i)
+			++counts[i ? src[i-1] : 0][src[i]];
+
+		std::array<uint8_t, 256> map;
+		std::vector<histogram_t> clusters;
+		cluster_contexts(counts, std::min(tables, MAX_CONTEXT_TABLES), map, clusters);
+
+		out.push_back(2);
+		out.push_back(clusters.size());
+		BitWriter writer(out);
+		for(const auto& cluster: map)
+			writer.put(cluster, context_bits(clusters.size()));
+		writer.flush();
+
+		std::vector<codes_t> codes;
+		for(const auto& cluster: clusters){
+			table_t lengths = build_lengths(cluster, max_length);
+			write_lengths(writer, lengths);
+			codes.push_back(canonical_codes(lengths));
+		}
+
+		const codes_t* table[256];
+		for(size_t c=0; c<256; ++c)
+			table[c] = &codes[map[c]];
+		for(size_t i=0; i<size; ++i){
+			const auto& code = (*table[i ? src[i-1] : 0])[src[i]];
+			writer.put(code.bits, code.length);
+		}
+		writer.flush();
+	}
+
+	inline bool decode_context_block(BitReader& reader, uint8_t* dest, size_t count){
+		size_t table_count = reader.get(8);
+		if(!table_count || table_count > MAX_CONTEXT_TABLES)
+			return false;
+
+		std::array<uint8_t, 256> map;
+		for(auto& cluster: map){
+			cluster = reader.get(context_bits(table_count));
+			if(cluster >= table_count)
+				return false;
+		}
+		reader.get((8 - reader.position() % 8) % 8);
+
+		std::vector<Decoder> decoders;
+		for(size_t j=0; j<table_count; ++j){
+			table_t lengths;
+			if(!read_lengths(reader, lengths))
+				return false;
+			decoders.emplace_back(lengths);
+			if(!decoders.back().valid())
+				return false;
+		}
+
+		const Decoder* decoder[256];
+		for(size_t c=0; c<256; ++c)
+			decoder[c] = &decoders[map[c]];
+		int symbol = 0;
+		size_t i = 0;
+		for(; i+2<=count; i+=2){
+			reader.refill();
+			if((symbol = decoder[symbol]->lookup(reader)) < 0)
+				return false;
+			dest[i] = symbol;
+			if((symbol = decoder[symbol]->lookup(reader)) < 0)
+				return false;
+			dest[i+1] = symbol;
+		}
+		if(i < count){
+			if((symbol = decoder[symbol]->decode(reader)) < 0)
+				return false;
+			dest[i] = symbol;
+		}
+		return !reader.overrun();
+	}
+
+	/* Args:
+	 * 	src		- record written by encode_block
+	 * 	size	- record size in bytes
+	 * 	dest	- buffer for the `count` raw bytes of the block
+	 *
+	 * 	Returns false if the record is corrupted
+	 */
+	inline bool decode_block(BitReader& reader, uint8_t* dest, size_t count){
+		table_t lengths;
+		size_t mode = reader.get(8);
+		if(mode == 2)
+			return decode_context_block(reader, dest, count);
+		if(mode > 1 || !read_lengths(reader, lengths))
+			return false;
+
+		Decoder decoder(lengths);
+		return decoder.valid() && decode_payload(reader, decoder, dest, count, mode);
+	}
+
+	inline bool decode_block(const uint8_t* src, size_t size, uint8_t* dest, size_t count){
+		BitReader reader(src, size);
+		return decode_block(reader, dest, count);
+	}
+
+	/* Args:
+	 * 	fd_in		- file descriptor to read the raw bytes from
+	 * 	fd_out		- file descriptor to write the stream format to
+	 * 	block_size	- input bytes per block
+	 * 	max_length	- longest code allowed (see build_lengths)
+	 * 	interleaved	- 4 interleaved substreams per block (see encode_payload)
+	 * 	tables		- order-1 mode code tables per block (see encode_block)
+	 *
+	 * 	Returns false on an I/O error
+	 */
+	inline bool compress(int fd_in, int fd_out, size_t block_size=BLOCK_SIZE, 
+			size_t max_length=MAX_CODE_LENGTH, bool interleaved=true, size_t tables=0){
+		if(!block_size || block_size > UINT32_MAX)
+			block_size = BLOCK_SIZE;
+
+		std::vector<uint8_t> in(block_size), out;
+		if(!write_all(fd_out, MAGIC, sizeof(MAGIC)))
+			return false;
+
+		size_t size;
+		while((size = read_all(fd_in, in.data(), block_size))){
+			out.clear();
+			put_u32(out, size);
+			put_u32(out, 0);
+			encode_block(in.data(), size, out, max_length, interleaved, tables);
+
+			uint32_t record_size = out.size() - 8;
+			out[4] = record_size >> 24; out[5] = record_size >> 16;
+			out[6] = record_size >> 8; out[7] = record_size;
+			if(!write_all(fd_out, out.data(), out.size()))
+				return false;
+		}
+
+		out.clear();
+		put_u32(out, 0);
+		return write_all(fd_out, out.data(), out.size());
+	}
+
+	/* Args:
+	 * 	fd_in	- file descriptor to read the stream format from
+	 * 	fd_out	- file descriptor to write the raw bytes to
+	 *
+	 * 	Returns false on an I/O error or a corrupted stream
+	 */
+	inline bool decompress(int fd_in, int fd_out){
+		uint8_t header[8];
+		if(read_all(fd_in, header, sizeof(MAGIC)) != sizeof(MAGIC) || 
+				!std::equal(MAGIC, MAGIC+sizeof(MAGIC), reinterpret_cast<const char*>(header))){
+			fprintf(stderr, "WARNING[huffman::decompress]: Not a huffman stream!\n");
+			return false;
+		}
+
+		std::vector<uint8_t> in, out;
+		while(true){
+			if(read_all(fd_in, header, 4) != 4)
+				break;
+			uint32_t size = get_u32(header);
+			if(!size)
+				return true;
+			if(read_all(fd_in, header+4, 4) != 4)
+				break;
+			uint32_t record_size = get_u32(header+4);
+
+			in.resize(record_size);
+			out.resize(size);
+			if(read_all(fd_in, in.data(), record_size) != record_size)
+				break;
+			if(!decode_block(in.data(), record_size, out.data(), size)){
+				fprintf(stderr, "WARNING[huffman::decompress]: Corrupted block!\n");
+				return false;
+			}
+			if(!write_all(fd_out, out.data(), size))
+				return false;
+		}
+
+		fprintf(stderr, "WARNING[huffman::decompress]: Unexpected end of stream!\n");
+		return false;
+	}
+
+	/* Block format
+	 *
+	 * 	"HUFP" header [lengths] index blocks
+	 * 	header	- raw size (u64), block size (u32), block count (u32), flags (u8:
+	 * 			  1 if the table is shared, 2 if the payloads are interleaved)
+	 * 	lengths	- code lengths of all the blocks if the table is shared (as in a record)
+	 * 	index	- bit offset of every block from the start of the blocks (u64)
+	 * 	block	- record as in the stream format, or the payload if the table is shared
+	 *
+	 * Blocks are encoded and decoded independently, so both directions run
+	 * one block per worker thread. Blocks are padded to whole bytes.
+	 */
+
+	/* Args:
+	 * 	src				- input bytes
+	 * 	size			- number of bytes
+	 * 	block_size		- input bytes per block
+	 * 	shared_table	- one table built from the whole input instead of one per block
+	 * 	thread_count	- maximum number of worker threads (0: one per core)
+	 * 	max_length		- longest code allowed (see build_lengths)
+	 * 	interleaved		- 4 interleaved substreams per block (see encode_payload)
+	 */
+	inline std::vector<uint8_t> compress_blocks(const uint8_t* src, size_t size, size_t block_size=BLOCK_SIZE, 
+			bool shared_table=false, size_t thread_count=0, size_t max_length=MAX_CODE_LENGTH, bool interleaved=true){
+		if(!block_size || block_size > UINT32_MAX)
+			block_size = BLOCK_SIZE;
+		size_t block_count = (size + block_size - 1) / block_size;
+
+		table_t lengths;
+		codes_t codes;
+		if(shared_table){
+			lengths = build_lengths(histogram(src, size, thread_count), max_length);
+			codes = canonical_codes(lengths);
+		}
+
+		std::vector<std::vector<uint8_t>> blocks(block_count);
+		parallel_for(block_count, thread_count, [&](size_t i){
+			const uint8_t* begin = src + i * block_size;
+			size_t count = std::min(block_size, size - i * block_size);
+			if(shared_table)
+				encode_payload(begin, count, codes, blocks[i], interleaved);
+			else
+				encode_block(begin, count, blocks[i], max_length, interleaved);
+		});
+
+		std::vector<uint8_t> out(BLOCKS_MAGIC, BLOCKS_MAGIC+sizeof(BLOCKS_MAGIC));
+		put_u64(out, size);
+		put_u32(out, block_size);
+		put_u32(out, block_count);
+		out.push_back(shared_table | interleaved << 1);
+		if(shared_table){
+			BitWriter writer(out);
+			write_lengths(writer, lengths);
+		}
+
+		size_t offset = 0;
+		for(const auto& block: blocks){
+			put_u64(out, 8 * offset);
+			offset += block.size();
+		}
+		out.reserve(out.size() + offset);
+		for(const auto& block: blocks)
+			out.insert(out.end(), block.cbegin(), block.cend());
+		return out;
+	}
+
+	/* Args:
+	 * 	src				- output of compress_blocks
+	 * 	size			- number of bytes
+	 * 	out				- decompressed bytes
+	 * 	thread_count	- maximum number of worker threads (0: one per core)
+	 *
+	 * 	Returns false if the input is corrupted
+	 */
+	inline bool decompress_blocks(const uint8_t* src, size_t size, std::vector<uint8_t>& out, size_t thread_count=0){
+		const size_t HEADER_SIZE = sizeof(BLOCKS_MAGIC) + 8 + 4 + 4 + 1;
+		if(size < HEADER_SIZE || !std::equal(BLOCKS_MAGIC, BLOCKS_MAGIC+sizeof(BLOCKS_MAGIC), reinterpret_cast<const char*>(src))){
+			fprintf(stderr, "WARNING[huffman::decompress_blocks]: Not a huffman block stream!\n");
+			return false;
+		}
+		uint64_t raw_size = get_u64(src+4);
+		size_t block_size = get_u32(src+12), block_count = get_u32(src+16);
+		bool shared_table = src[20] & 1, interleaved = src[20] & 2;
+		size_t pos = HEADER_SIZE;
+
+		table_t lengths;
+		lengths.fill(0);
+		if(shared_table){
+			BitReader reader(src+pos, size-pos);
+			if(!read_lengths(reader, lengths)){
+				fprintf(stderr, "WARNING[huffman::decompress_blocks]: Corrupted header!\n");
+				return false;
+			}
+			pos += reader.position() / 8;
+		}
+		if(!block_size || block_count != (raw_size + block_size - 1) / block_size || 
+				(size - pos) / 8 < block_count){
+			fprintf(stderr, "WARNING[huffman::decompress_blocks]: Corrupted header!\n");
+			return false;
+		}
+
+		const uint8_t* index = src + pos;
+		const uint8_t* blocks = index + 8 * block_count;
+		size_t blocks_size = size - pos - 8 * block_count;
+		// a code is at least 1 bit long, and the index holds bit offsets
+		if(!index_fits(index, block_count, 8 * static_cast<uint64_t>(blocks_size)) || raw_size / 8 > blocks_size){
+			fprintf(stderr, "WARNING[huffman::decompress_blocks]: Corrupted header!\n");
+			return false;
+		}
+		Decoder shared(lengths);
+
+		out.resize(raw_size);
+		std::atomic<bool> ok(!shared_table || shared.valid());
+		parallel_for(block_count, thread_count, [&](size_t i){
+			// a block ends where the next one starts
+			uint64_t offset = get_u64(index + 8 * i);
+			uint64_t end = i+1 < block_count ? (get_u64(index + 8 * (i+1)) + 7) / 8 : blocks_size;
+			size_t count = std::min<uint64_t>(block_size, raw_size - i * block_size);
+			if(!ok || end > blocks_size || offset / 8 > end){
+				ok = false;
+				return;
+			}
+
+			BitReader reader(blocks + offset / 8, end - offset / 8);
+			reader.get(offset % 8);
+			uint8_t* dest = out.data() + i * block_size;
+			if(shared_table){
+				if(!decode_payload(reader, shared, dest, count, interleaved))
+					ok = false;
+			} else if(!decode_block(reader, dest, count)){
+				ok = false;
+			}
+		});
+
+		if(!ok)
+			fprintf(stderr, "WARNING[huffman::decompress_blocks]: Corrupted block!\n");
+		return ok;
+	}
+
+	/* AdaptiveModel class
+	 *
+	 * FGK adaptive Huffman tree shared by the encoder and the decoder: both
+	 * start from a lone NYT (not yet transmitted) node and apply the same
+	 * update after every symbol, so no table is ever sent. A new symbol is
+	 * sent as the NYT code followed by ESCAPE_BITS raw bits.
+	 *
+	 * Nodes are kept in a flat array indexed by their implicit number
+	 * (the root last); weights never decrease with the index, which is
+	 * the sibling property the update relies on.
+	 */
+	class AdaptiveModel{
+		public:
+		static const size_t SYMBOL_COUNT = 257;		// the bytes and the end mark
+		static const uint16_t END = 256;
+		static const size_t ESCAPE_BITS = 9;
+
+		protected:
+		// every symbol and the NYT node are leaves
+		static const int16_t ROOT = 2 * SYMBOL_COUNT;
+
+		struct node_t{
+			size_t weight;
+			int16_t parent, left, right;	// left/right are -1 for leaves
+			int16_t symbol;					// -1 for internal and NYT nodes
+		};
+
+		std::array<node_t, 2*SYMBOL_COUNT+1> m_nodes;
+		std::array<int16_t, SYMBOL_COUNT> m_leaf;	// leaf of every symbol (-1 if not seen yet)
+		int16_t m_nyt;
+
+		AdaptiveModel(): m_nyt(ROOT){
+			m_nodes[ROOT] = node_t{0, -1, -1, -1, -1};
+			m_leaf.fill(-1);
+		}
+
+		inline bool is_leaf(int16_t node) const{ return m_nodes[node].left < 0; }
+
+		inline void update(uint16_t symbol){
+			int16_t q = m_leaf[symbol];
+			if(q < 0){
+				// the NYT node gives birth to a new NYT node and the symbol's leaf
+				int16_t z = m_nyt;
+				m_nodes[z].left = z - 2;
+				m_nodes[z].right = z - 1;
+				m_nodes[z-1] = node_t{0, z, -1, -1, static_cast<int16_t>(symbol)};
+				m_nodes[z-2] = node_t{0, z, -1, -1, -1};
+				m_nyt = z - 2;
+				m_leaf[symbol] = q = z - 1;
+			}
+
+			while(true){
+				// swap with the highest numbered node of the same weight
+				int16_t leader = q;
+				while(leader < ROOT && m_nodes[leader+1].weight == m_nodes[q].weight)
+					++leader;
+				if(leader != q && leader != m_nodes[q].parent){
+					swap_nodes(q, leader);
+					q = leader;
+				}
+
+				++m_nodes[q].weight;
+				if(q == ROOT)
+					break;
+				q = m_nodes[q].parent;
+			}
+		}
+
+		private:
+		// swaps the subtrees at two positions (the positions keep their parents)
+		inline void swap_nodes(int16_t a, int16_t b){
+			std::swap(m_nodes[a].left, m_nodes[b].left);
+			std::swap(m_nodes[a].right, m_nodes[b].right);
+			std::swap(m_nodes[a].symbol, m_nodes[b].symbol);
+			std::swap(m_nodes[a].weight, m_nodes[b].weight);
+
+			for(int16_t node: { a, b }){
+				if(!is_leaf(node)){
+					m_nodes[m_nodes[node].left].parent = node;
+					m_nodes[m_nodes[node].right].parent = node;
+				} else if(m_nodes[node].symbol >= 0){
+					m_leaf[m_nodes[node].symbol] = node;
+				}
+			}
+			if(m_nyt == a || m_nyt == b)
+				m_nyt = m_nyt == a ? b : a;
+		}
+	};
+
+	class AdaptiveEncoder: public AdaptiveModel{
+		private:
+		BitWriter m_writer;
+
+		public:
+		// the codes are appended to `out`
+		explicit AdaptiveEncoder(std::vector<uint8_t>& out): m_writer(out) {}
+
+		inline void encode(uint16_t symbol){
+			int16_t leaf = m_leaf[symbol];
+			write_path(leaf >= 0 ? leaf : m_nyt);
+			if(leaf < 0)
+				m_writer.put(symbol, ESCAPE_BITS);
+			update(symbol);
+		}
+
+		inline void encode(const uint8_t* src, size_t size){
+			for(size_t i=0; i<size; ++i)
+				encode(src[i]);
+		}
+
+		// writes the end mark and the padding; the encoder is done afterwards
+		inline void finish(){
+			encode(END);
+			m_writer.flush();
+		}
+
+		private:
+		inline void write_path(int16_t node){
+			bool path[2*SYMBOL_COUNT+1];
+			size_t depth = 0;
+			for(; node != ROOT; node=m_nodes[node].parent)
+				path[depth++] = m_nodes[m_nodes[node].parent].right == node;
+			while(depth)
+				m_writer.put_bit(path[--depth]);
+		}
+	};
+
+	/* AdaptiveDecoder class
+	 *
+	 * Walks the tree one bit at a time, so it can be fed any number of
+	 * bytes at once (e.g. whatever a pipe returns) without waiting for a
+	 * whole code.
+	 */
+	class AdaptiveDecoder: public AdaptiveModel{
+		private:
+		int16_t m_node;
+		size_t m_escape;	// raw bits of a new symbol still to be read
+		uint16_t m_symbol;
+		bool m_finished, m_corrupted;
+
+		public:
+		AdaptiveDecoder(): m_node(ROOT), m_escape(ESCAPE_BITS), m_symbol(0), m_finished(false), m_corrupted(false) {}
+
+		/* Args:
+		 * 	src		- next bytes of the stream
+		 * 	size	- number of bytes
+		 * 	out		- buffer the decoded bytes are appended to
+		 *
+		 * 	Returns false once the end mark is decoded or the stream turns out to be corrupted
+		 */
+		inline bool decode(const uint8_t* src, size_t size, std::vector<uint8_t>& out){
+			for(size_t i=0; i<size; ++i){
+				for(size_t j=8; j--; ){
+					if(m_finished || m_corrupted)
+						return false;
+					feed((src[i] >> j) & 1, out);
+				}
+			}
+			return !m_finished && !m_corrupted;
+		}
+
+		inline bool finished() const{ return m_finished; }
+		inline bool corrupted() const{ return m_corrupted; }
+
+		private:
+		inline void feed(bool bit, std::vector<uint8_t>& out){
+			if(m_escape){
+				m_symbol = (m_symbol << 1) | bit;
+				if(!--m_escape){
+					if(m_symbol > END || m_leaf[m_symbol] >= 0)
+						m_corrupted = true;
+					else
+						emit(m_symbol, out);
+				}
+				return;
+			}
+
+			m_node = bit ? m_nodes[m_node].right : m_nodes[m_node].left;
+			if(m_node == m_nyt){
+				m_escape = ESCAPE_BITS;
+				m_symbol = 0;
+			} else if(is_leaf(m_node)){
+				emit(m_nodes[m_node].symbol, out);
+			}
+		}
+
+		inline void emit(uint16_t symbol, std::vector<uint8_t>& out){
+			if(symbol == END)
+				m_finished = true;
+			else
+				out.push_back(symbol);
+			update(symbol);
+			m_node = ROOT;
+		}
+	};
+
+	/* Args:
+	 * 	fd_in	- file descriptor to read the raw bytes from (e.g. a pipe or a socket)
+	 * 	fd_out	- file descriptor to write the adaptive stream to
+	 *
+	 * 	Single pass: every chunk is encoded as soon as read() returns it, and
+	 * 	the complete bytes are written right away.
+	 *
+	 * 	Returns false on an I/O error
+	 */
+	inline bool compress_adaptive(int fd_in, int fd_out){
+		std::vector<uint8_t> in(ADAPTIVE_CHUNK), out;
+		AdaptiveEncoder encoder(out);
+		if(!write_all(fd_out, ADAPTIVE_MAGIC, sizeof(ADAPTIVE_MAGIC)))
+			return false;
+
+		while(true){
+			ssize_t n = read(fd_in, in.data(), in.size());
+			if(n < 0 && errno == EINTR)
+				continue;
+			if(n < 0)
+				return false;
+			if(!n)
+				break;
+
+			encoder.encode(in.data(), n);
+			if(!write_all(fd_out, out.data(), out.size()))
+				return false;
+			out.clear();
+		}
+
+		encoder.finish();
+		return write_all(fd_out, out.data(), out.size());
+	}
+
+	/* Args:
+	 * 	fd_in	- file descriptor to read the adaptive stream from
+	 * 	fd_out	- file descriptor to write the raw bytes to
+	 *
+	 * 	Returns false on an I/O error or a corrupted stream
+	 */
+	inline bool decompress_adaptive(int fd_in, int fd_out){
+		uint8_t magic[sizeof(ADAPTIVE_MAGIC)];
+		if(read_all(fd_in, magic, sizeof(magic)) != sizeof(magic) || 
+				!std::equal(ADAPTIVE_MAGIC, ADAPTIVE_MAGIC+sizeof(ADAPTIVE_MAGIC), reinterpret_cast<const char*>(magic))){
+			fprintf(stderr, "WARNING[huffman::decompress_adaptive]: Not an adaptive huffman stream!\n");
+			return false;
+		}
+
+		std::vector<uint8_t> in(ADAPTIVE_CHUNK), out;
+		AdaptiveDecoder decoder;
+		while(!decoder.finished()){
+			ssize_t n = read(fd_in, in.data(), in.size());
+			if(n < 0 && errno == EINTR)
+				continue;
+			if(n <= 0)
+				break;
+
+			decoder.decode(in.data(), n, out);
+			if(decoder.corrupted()){
+				fprintf(stderr, "WARNING[huffman::decompress_adaptive]: Corrupted stream!\n");
+				return false;
+			}
+			if(!write_all(fd_out, out.data(), out.size()))
+				return false;
+			out.clear();
+		}
+
+		if(!decoder.finished())
+			fprintf(stderr, "WARNING[huffman::decompress_adaptive]: Unexpected end of stream!\n");
+		return decoder.finished();
+	}
+}
@@ -0,0 +1,282 @@
+
+#ifndef _LZ77_
+#define _LZ77_
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include "../Bit-Stream/bit_io.h"
+#include "../Bit-Stream/codec_util.h"
+
+
+namespace lz77{
+	// shortest/longest match worth a token (the length is sent in 8 bits)
+	static const size_t MIN_MATCH = 4;
+	static const size_t MAX_MATCH = MIN_MATCH + 255;
+
+	// window of 2^bits bytes; a distance is sent in `bits` bits
+	static const size_t MIN_WINDOW_BITS = 8;
+	static const size_t MAX_WINDOW_BITS = 24;
+	static const size_t DEFAULT_WINDOW_BITS = 16;
+	// candidates tried per position; trades speed for ratio
+	static const size_t DEFAULT_CHAIN = 32;
+	// a match at least this long is taken without looking one byte ahead
+	static const size_t LAZY_LENGTH = 32;
+
+	static const char MAGIC[4] = { 'L', 'Z', '7', '7' };
+	// end of a hash chain
+	static const size_t NO_POSITION = SIZE_MAX;
+
+	// literal if `length` is 0 (`value` is the byte), otherwise a match `value` bytes back
+	struct token_t{
+		uint32_t length;
+		uint32_t value;
+	};
+
+	// length of the common prefix of `a` and `b`, at most `limit`
+	inline size_t match_length(const uint8_t* a, const uint8_t* b, size_t limit){
+		size_t length = 0;
+		while(length + 8 <= limit){
+			uint64_t x, y;
+			memcpy(&x, a + length, 8);
+			memcpy(&y, b + length, 8);
+			if(x != y)
+				return length + (__builtin_ctzll(x ^ y) >> 3);
+			length += 8;
+		}
+		while(length < limit && a[length] == b[length])
+			++length;
+		return length;
+	}
+
+	/* Matcher class
+	 *
+	 * Hash-chain match finder: positions are hashed on their next 4 bytes,
+	 * `m_head` holds the latest position of every hash and `m_prev` links
+	 * each position of the window to the previous one with the same hash.
+	 * A search walks the chain from the newest candidate back to the edge
+	 * of the window, giving up after `chain` candidates.
+	 */
+	class Matcher{
+		static const size_t HASH_BITS = 16;
+
+		private:
+		const uint8_t* m_src;
+		size_t m_size;
+		size_t m_window;
+		size_t m_chain;
+		std::vector<size_t> m_head;
+		std::vector<size_t> m_prev;
+
+		public:
+		/* Args:
+		 * 	src			- input bytes
+		 * 	size		- number of bytes
+		 * 	window_bits	- matches reach at most 2^window_bits bytes back
+		 * 	chain		- maximum number of candidates per search
+		 */
+		Matcher(const uint8_t* src, size_t size, size_t window_bits, size_t chain):
+			m_src(src), m_size(size), m_window(static_cast<size_t>(1) << window_bits), m_chain(chain ? chain : 1),
+			m_head(static_cast<size_t>(1) << HASH_BITS, NO_POSITION), m_prev(std::min(m_window, size ? size : 1), NO_POSITION) {}
+
+		// adds position `pos` to its chain (positions must come in order)
+		inline void insert(size_t pos){
+			if(pos + 4 > m_size)
+				return;
+			size_t& head = m_head[hash(pos)];
+			m_prev[pos % m_prev.size()] = head;
+			head = pos;
+		}
+
+		// longest match for position `pos` (inserted already); returns its length, 0 if none
+		inline size_t find(size_t pos, size_t& distance) const{
+			size_t best = 0;
+			size_t limit = std::min(MAX_MATCH, m_size - pos);
+			if(limit < MIN_MATCH)
+				return 0;
+
+			size_t candidate = m_prev[pos % m_prev.size()];
+			for(size_t i=0; i<m_chain && candidate != NO_POSITION && pos - candidate <= m_window; ++i){
+				// a longer match must also beat the byte that ends the best one
+				if(m_src[candidate + best] == m_src[pos + best]){
+					size_t length = match_length(m_src + candidate, m_src + pos, limit);
+					if(length > best){
+						best = length;
+						distance = pos - candidate;
+						if(length == limit)
+							break;
+					}
+				}
+				size_t next = m_prev[candidate % m_prev.size()];
+				// the slot was reused by a position past the window
+				if(next != NO_POSITION && next >= candidate)
+					break;
+				candidate = next;
+			}
+			return best >= MIN_MATCH ? best : 0;
+		}
+
+		private:
+		inline size_t hash(size_t pos) const{
+			uint32_t word;
+			memcpy(&word, m_src + pos, 4);
+			return (word * 2654435761u) >> (32 - HASH_BITS);
+		}
+	};
+
+	/* Args:
+	 * 	src			- input bytes
+	 * 	size		- number of bytes
+	 * 	function	- called with every token_t, in order
+	 * 	window_bits	- matches reach at most 2^window_bits bytes back
+	 * 	chain		- maximum number of candidates per search
+	 * 	lazy		- a match is deferred if the next position has a longer one
+	 */
+	template<typename F>
+	inline void parse(const uint8_t* src, size_t size, const F& function,
+			size_t window_bits=DEFAULT_WINDOW_BITS, size_t chain=DEFAULT_CHAIN, bool lazy=true){
+		Matcher matcher(src, size, window_bits, chain);
+		size_t pos = 0, length = 0, distance = 0;
+		if(size){
+			matcher.insert(0);
+			length = matcher.find(0, distance);
+		}
+
+		while(pos < size){
+			if(!length){
+				function(token_t{0, src[pos]});
+				matcher.insert(++pos);
+				length = pos < size ? matcher.find(pos, distance) : 0;
+				continue;
+			}
+
+			// one byte later may start a longer match: the current byte goes out as a literal
+			if(lazy && length < LAZY_LENGTH && pos + 1 < size){
+				size_t next_distance = 0;
+				matcher.insert(pos + 1);
+				size_t next_length = matcher.find(pos + 1, next_distance);
+				if(next_length > length){
+					function(token_t{0, src[pos]});
+					++pos;
+					length = next_length;
+					distance = next_distance;
+					continue;
+				}
+				function(token_t{static_cast<uint32_t>(length), static_cast<uint32_t>(distance)});
+				for(size_t i=pos+2; i<pos+length; ++i)
+					matcher.insert(i);
+			} else{
+				function(token_t{static_cast<uint32_t>(length), static_cast<uint32_t>(distance)});
+				for(size_t i=pos+1; i<pos+length; ++i)
+					matcher.insert(i);
+			}
+
+			pos += length;
+			matcher.insert(pos);
+			length = pos < size ? matcher.find(pos, distance) : 0;
+		}
+	}
+
+	/* Stream format
+	 *
+	 * 	"LZ77" window bits (u8) raw size (u64) tokens
+	 * 	literal	- 0 bit, the byte (8 bits)
+	 * 	match	- 1 bit, length - MIN_MATCH (8 bits), distance - 1 (window bits)
+	 *
+	 * Tokens are packed MSB-first and the last byte is padded with zeros.
+	 * Decoding stops after `raw size` bytes, so no end token is needed.
+	 */
+
+	/* Args:
+	 * 	src			- input bytes
+	 * 	size		- number of bytes
+	 * 	window_bits	- window of 2^window_bits bytes [MIN_WINDOW_BITS, MAX_WINDOW_BITS]
+	 * 	chain		- maximum number of match candidates per position
+	 * 	lazy		- lazy matching (see parse)
+	 */
+	inline std::vector<uint8_t> compress(const uint8_t* src, size_t size, size_t window_bits=DEFAULT_WINDOW_BITS,
+			size_t chain=DEFAULT_CHAIN, bool lazy=true){
+		window_bits = std::max(MIN_WINDOW_BITS, std::min(window_bits, MAX_WINDOW_BITS));
+		std::vector<uint8_t> out(MAGIC, MAGIC+sizeof(MAGIC));
+		out.push_back(window_bits);
+		put_u64(out, size);
+
+		BitWriter writer(out);
+		parse(src, size, [&](const token_t& token){
+			if(token.length){
+				writer.put(1 << 8 | (token.length - MIN_MATCH), 9);
+				writer.put(token.value - 1, window_bits);
+			} else{
+				writer.put(token.value, 9);
+			}
+		}, window_bits, chain, lazy);
+		writer.flush();
+		return out;
+	}
+
+	inline std::vector<uint8_t> compress(const std::string& data, size_t window_bits=DEFAULT_WINDOW_BITS){
+		return compress(reinterpret_cast<const uint8_t*>(data.data()), data.size(), window_bits);
+	}
+
+	/* Args:
+	 * 	src		- output of compress
+	 * 	size	- number of bytes
+	 * 	out		- decompressed bytes
+	 *
+	 * 	Returns false if the input is corrupted
+	 */
+	inline bool decompress(const uint8_t* src, size_t size, std::vector<uint8_t>& out){
+		const size_t HEADER_SIZE = sizeof(MAGIC) + 1 + 8;
+		if(size < HEADER_SIZE || !std::equal(MAGIC, MAGIC+sizeof(MAGIC), reinterpret_cast<const char*>(src))){
+			fprintf(stderr, "WARNING[lz77::decompress]: Not an lz77 stream!\n");
+			return false;
+		}
+		size_t window_bits = src[4];
+		uint64_t raw_size = get_u64(src+5);
+		// a token of 9 + window_bits bits yields at most MAX_MATCH bytes
+		if(window_bits < MIN_WINDOW_BITS || window_bits > MAX_WINDOW_BITS || 
+				raw_size / MAX_MATCH > 8 * size / (9 + window_bits)){
+			fprintf(stderr, "WARNING[lz77::decompress]: Corrupted header!\n");
+			return false;
+		}
+
+		out.resize(raw_size);
+		uint8_t* dest = out.data();
+		BitReader reader(src + HEADER_SIZE, size - HEADER_SIZE);
+		size_t pos = 0;
+		while(pos < raw_size){
+			if(!reader.get_bit()){
+				dest[pos++] = reader.get(8);
+				continue;
+			}
+
+			size_t length = reader.get(8) + MIN_MATCH;
+			size_t distance = reader.get(window_bits) + 1;
+			if(distance > pos || length > raw_size - pos){
+				fprintf(stderr, "WARNING[lz77::decompress]: Invalid match at %zu!\n", pos);
+				return false;
+			}
+			// overlapping matches repeat the last `distance` bytes
+			const uint8_t* from = dest + pos - distance;
+			if(distance >= length){
+				memcpy(dest + pos, from, length);
+			} else{
+				for(size_t i=0; i<length; ++i)
+					dest[pos + i] = from[i];
+			}
+			pos += length;
+		}
+
+		if(reader.overrun()){
+			fprintf(stderr, "WARNING[lz77::decompress]: Truncated stream!\n");
+			return false;
+		}
+		return true;
+	}
+}
+
+#endif
@@ -1,14 +1,42 @@
 #include "lzw.h"
+#include <fcntl.h>
+#include <string.h>
 
 using namespace std;
 using namespace lzw;
 
+// "-" stands for the standard input/output
+int open_file(const char* path, bool output){
+	if(!strcmp(path, "-"))
+		return output ? STDOUT_FILENO : STDIN_FILENO;
+	return output ? open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644) : open(path, O_RDONLY);
+}
+
 int main(int argc, const char** argv){
+	// -c/-d: streaming mode
+	const string mode = argc == 4 ? argv[1] : "";
+	if(mode == "-c" || mode == "-d"){
+		int fd_in = open_file(argv[2], false), fd_out = open_file(argv[3], true);
+		if(fd_in < 0 || fd_out < 0){
+			fprintf(stderr, "ERROR: Unable to open %s!\n", fd_in < 0 ? argv[2] : argv[3]);
+			return 1;
+		}
+
+		bool ok = mode == "-c" ? compress(fd_in, fd_out) : decompress(fd_in, fd_out);
+		close(fd_in);
+		close(fd_out);
+		return !ok;
+	} else if(argc > 2){
+		fprintf(stderr, "Usage: %s [text] | -c <input> <output> | -d <input> <output>\n", argv[0]);
+		return 1;
+	}
+
 	string text = "hello, my name is world and this is an example of lzw compression.";
+	if(argc == 2) text = string(argv[1]);
 	auto encoded = compress(text);
 	string decoded = decompress(encoded);
 	printf("%s\n", decoded.c_str());
-	printf("Compression Ratio: %.3f\n", (float)(text.size()-encoded.size())/text.size());
+	printf("Compression Ratio: %.3f\n", ((float)text.size()-encoded.size())/text.size());
 	printf("%zu - %zu\n", encoded.size(), text.size());
 	return 0;
 }
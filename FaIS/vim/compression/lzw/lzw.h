@@ -1,84 +1,749 @@
 
+#ifndef _LZW_
+#define _LZW_
+
 #include <cstdio>
 #include <cstdlib>
+#include <cstdint>
 #include <map>
 #include <vector>
 #include <string>
 #include <algorithm>
-#include "bit_stream.h"
+#include "../Bit-Stream/bit_io.h"
+#include "../Bit-Stream/codec_util.h"
 
 
 namespace lzw{
-	using table_t = std::vector<std::string>;
-	using compressed_data_t = std::vector<size_t>;
+	// dictionary string: its longest proper prefix (a code) plus its last byte
+	struct entry_t{
+		uint32_t prefix;
+		uint32_t length;
+		uint8_t byte;
+	};
+	// codes packed MSB-first, each as wide as the code counter (see code_width)
+	using compressed_data_t = std::vector<uint8_t>;
 
-	compressed_data_t compress(const std::string& data){
-		compressed_data_t out;
-		table_t table(128);
-
-		// Initializing the table
-		printf("Initializing the table...\n");
-		for(unsigned char c=0; c<128; ++c)
-			table[c] = std::string(1, c);
-
-		// Compressing
-		printf("Compressing...\n");
-		std::string curr, tmp;
-		for(size_t i=0; i<data.size(); ++i){
-			const char& c = data[i];
-			tmp = curr + c;
-			auto it = std::find(table.cbegin(), table.cend(), tmp);
-
-			if(it == table.cend()){
-				out.push_back(std::find(table.cbegin(), table.cend(), curr) - table.cbegin());
-				table.push_back(tmp);
-				curr = std::string(1, c);
-			} else{
-				curr = tmp;
+	// single-byte strings the dictionary starts with (codes 0 ... ALPHABET_SIZE-1)
+	static const size_t ALPHABET_SIZE = 256;
+	// tells the decoder that the dictionary was reset (RESET policy)
+	static const uint32_t CLEAR_CODE = ALPHABET_SIZE;
+	// first code given to a dictionary string
+	static const uint32_t FIRST_CODE = CLEAR_CODE + 1;
+	static const uint32_t NO_CODE = UINT32_MAX;
+
+	// bounds of the code width, i.e. of the dictionary size (2^width codes)
+	static const size_t MIN_CODE_WIDTH = 9;
+	static const size_t MAX_CODE_WIDTH = 24;
+	static const size_t DEFAULT_CODE_WIDTH = 16;
+	// codes the dictionaries have room for before they first grow
+	static const size_t INITIAL_CAPACITY = 1 << 12;
+
+	/* What happens once every code of the maximum width is taken:
+	 * 	FREEZE	- the dictionary stops growing and is used as is
+	 * 	RESET	- a CLEAR_CODE is emitted and both sides start over
+	 * 	PRUNE	- the least recently emitted string no other entry extends
+	 * 		  gives its code to the new string
+	 */
+	enum policy_t{ FREEZE=0, RESET=1, PRUNE=2 };
+
+	/* Width of a code emitted while `next` is the next free code. The
+	 * decoder knows `next` from the number of codes read so far, so the
+	 * width grows at the same code on both sides.
+	 */
+	inline size_t code_width(size_t next){
+		return 64 - __builtin_clzll(next);
+	}
+	// same, once the codes stop at `max_width` bits
+	inline size_t code_width(size_t next, size_t max_width){
+		return std::min(code_width(next), max_width);
+	}
+
+	/* Dictionary class
+	 *
+	 * LZW string table of the compressor. A string is never stored: every
+	 * entry is the code of its longest proper prefix plus its last byte,
+	 * kept in an open-addressing hash table, so extending the current
+	 * match by one byte is a single probe sequence without allocation.
+	 */
+	class Dictionary{
+		struct slot_t{
+			uint64_t key;	// (prefix + 1) << 8 | byte, 0 if the slot is empty
+			uint32_t code;
+		};
+
+		public:
+		static const uint32_t NONE = NO_CODE;
+
+		private:
+		std::vector<slot_t> m_slots;
+		size_t m_size;
+		size_t m_initial;	// number of slots to start over with
+
+		public:
+		// the table starts with room for `capacity` strings and doubles as they are inserted
+		explicit Dictionary(size_t capacity=INITIAL_CAPACITY): m_slots(1), m_size(0){
+			while(m_slots.size() < 2 * capacity)
+				m_slots.resize(2 * m_slots.size());
+			m_slots.assign(m_slots.size(), slot_t{0, 0});
+			m_initial = m_slots.size();
+		}
+
+		inline size_t size() const{ return m_size; }
+
+		// code of the string `prefix` + `byte`, or NONE
+		inline uint32_t find(uint32_t prefix, uint8_t byte) const{
+			uint64_t key = make_key(prefix, byte);
+			for(size_t i=hash(key); ; i=(i+1)&(m_slots.size()-1)){
+				if(m_slots[i].key == key)
+					return m_slots[i].code;
+				if(!m_slots[i].key)
+					return NONE;
+			}
+		}
+
+		inline void insert(uint32_t prefix, uint8_t byte, uint32_t code){
+			// keeps the load factor below 1/2
+			if(2 * (m_size + 1) > m_slots.size())
+				grow();
+			place(make_key(prefix, byte), code);
+			++m_size;
+		}
+
+		inline void erase(uint32_t prefix, uint8_t byte){
+			uint64_t key = make_key(prefix, byte);
+			size_t mask = m_slots.size() - 1, i = hash(key);
+			while(m_slots[i].key != key){
+				if(!m_slots[i].key)
+					return;
+				i = (i + 1) & mask;
+			}
+
+			// shifts back the entries whose probe sequence went through the hole
+			for(size_t j=(i+1)&mask; m_slots[j].key; j=(j+1)&mask){
+				size_t home = hash(m_slots[j].key);
+				if(((j - home) & mask) >= ((j - i) & mask)){
+					m_slots[i] = m_slots[j];
+					i = j;
+				}
 			}
+			m_slots[i] = slot_t{0, 0};
+			--m_size;
+		}
+
+		// shrinks back to the initial size, so a reset costs no more than what was inserted
+		inline void clear(){
+			m_slots.assign(m_initial, slot_t{0, 0});
+			m_size = 0;
+		}
+
+		private:
+		static inline uint64_t make_key(uint32_t prefix, uint8_t byte){
+			return (static_cast<uint64_t>(prefix) + 1) << 8 | byte;
+		}
+
+		inline size_t hash(uint64_t key) const{
+			return (key * 0x9e3779b97f4a7c15ULL) >> (64 - __builtin_ctzll(m_slots.size()));
+		}
+
+		inline void place(uint64_t key, uint32_t code){
+			size_t i = hash(key);
+			while(m_slots[i].key)
+				i = (i + 1) & (m_slots.size() - 1);
+			m_slots[i] = slot_t{key, code};
 		}
-		out.push_back(std::find(table.cbegin(), table.cend(), curr) - table.cbegin());
-		
-		char null = 0;
-		for(size_t i=0; i<table.size(); ++i){
-			const char* str = &null;
-			if(table[i][0] >= 32 && table[i][0] <= 127)
-				str = table[i].c_str();
-			printf("[%s]: %zu\n", str, i);
+
+		inline void grow(){
+			std::vector<slot_t> slots(2 * m_slots.size(), slot_t{0, 0});
+			slots.swap(m_slots);
+			for(const auto& slot: slots){
+				if(slot.key)
+					place(slot.key, slot.code);
+			}
 		}
+	};
+
+	/* Recency class
+	 *
+	 * Dictionary strings that no other entry extends (the only ones whose
+	 * code can be taken away) from the least to the most recently emitted,
+	 * for the PRUNE policy. The compressor and the decompressor feed it the
+	 * same events in the same order, so both pick the same code to recycle.
+	 * The tables grow with the codes that are added.
+	 */
+	class Recency{
+		private:
+		// circular list through the codes; CLEAR_CODE, never a string, is the sentinel
+		std::vector<uint32_t> m_prev, m_next;
+		std::vector<uint32_t> m_children;
+		static const uint32_t END = CLEAR_CODE;
 
-		for(const auto& index: out)
-			printf("%zu ", index);
-		printf("\n");
+		public:
+		explicit Recency(size_t capacity=INITIAL_CAPACITY):
+			m_prev(std::max<size_t>(capacity, FIRST_CODE), NO_CODE), m_next(m_prev.size(), NO_CODE),
+			m_children(m_prev.size(), 0) { clear(); }
 
+		inline void clear(){
+			std::fill(m_prev.begin(), m_prev.end(), NO_CODE);
+			std::fill(m_children.begin(), m_children.end(), 0);
+			m_prev[END] = m_next[END] = END;
+		}
+
+		// least recently emitted leaf, or NONE
+		inline uint32_t oldest() const{
+			return m_next[END] == END ? NO_CODE : m_next[END];
+		}
+
+		// `code` was emitted
+		inline void touch(uint32_t code){
+			if(linked(code)){
+				unlink(code);
+				link(code);
+			}
+		}
+
+		// `code` now stands for `prefix` + a byte
+		inline void add(uint32_t code, uint32_t prefix){
+			if(code >= m_prev.size()){
+				size_t size = 2 * m_prev.size();
+				m_prev.resize(size, NO_CODE);
+				m_next.resize(size, NO_CODE);
+				m_children.resize(size, 0);
+			}
+			if(prefix >= FIRST_CODE && m_children[prefix]++ == 0)
+				unlink(prefix);
+			m_children[code] = 0;
+			link(code);
+		}
+
+		// `code`, which extended `prefix`, is recycled
+		inline void remove(uint32_t code, uint32_t prefix){
+			unlink(code);
+			if(prefix >= FIRST_CODE && --m_children[prefix] == 0)
+				link(prefix);
+		}
+
+		private:
+		inline bool linked(uint32_t code) const{ return m_prev[code] != NO_CODE; }
+
+		inline void link(uint32_t code){
+			m_prev[code] = m_prev[END];
+			m_next[code] = END;
+			m_next[m_prev[END]] = code;
+			m_prev[END] = code;
+		}
+
+		inline void unlink(uint32_t code){
+			m_next[m_prev[code]] = m_next[code];
+			m_prev[m_next[code]] = m_prev[code];
+			m_prev[code] = NO_CODE;
+		}
+	};
+
+	/* Encoder class
+	 *
+	 * Incremental compressor: bytes are fed in chunks of any size and the
+	 * packed codes are appended to the output buffer as soon as they are
+	 * known, so the caller may drain (write out and clear) the buffer after
+	 * every chunk. The first byte written is the header: the policy (high 3
+	 * bits) and the maximum code width.
+	 */
+	class Encoder{
+		private:
+		size_t m_max_width;
+		policy_t m_policy;
+		uint32_t m_limit;
+		BitWriter m_writer;
+		Dictionary m_dictionary;
+		// string of every code, to unlink it from the dictionary (PRUNE)
+		std::vector<std::pair<uint32_t, uint8_t>> m_entries;
+		Recency m_recency;
+		uint32_t m_next;
+		uint32_t m_curr;	// code of the string matched so far, NO_CODE before the first byte
+
+		public:
+		/* Args:
+		 * 	out		- buffer the compressed bytes are appended to
+		 * 	max_width	- widest code [MIN_CODE_WIDTH, MAX_CODE_WIDTH]; the
+		 * 			  dictionary holds at most 2^max_width strings
+		 * 	policy		- what to do once the dictionary is full
+		 */
+		explicit Encoder(std::vector<uint8_t>& out, size_t max_width=DEFAULT_CODE_WIDTH, policy_t policy=RESET):
+			m_max_width(std::max(MIN_CODE_WIDTH, std::min(max_width, MAX_CODE_WIDTH))),
+			m_policy(policy), m_limit(1u << m_max_width), m_writer(out), m_dictionary(),
+			m_entries(policy == PRUNE ? INITIAL_CAPACITY : 0), m_recency(policy == PRUNE ? INITIAL_CAPACITY : 0),
+			m_next(FIRST_CODE), m_curr(NO_CODE){
+			out.push_back(static_cast<uint8_t>(policy << 5 | m_max_width));
+		}
+
+		inline void encode(const uint8_t* src, size_t size){
+			size_t i = 0;
+			if(m_curr == NO_CODE && size)
+				m_curr = src[i++];
+			for(; i<size; ++i){
+				uint32_t code = m_dictionary.find(m_curr, src[i]);
+				if(code == NO_CODE){
+					emit(src[i]);
+					m_curr = src[i];
+				} else{
+					m_curr = code;
+				}
+			}
+		}
+
+		// writes the last code and pads the output to a whole byte
+		inline void finish(){
+			if(m_curr != NO_CODE)
+				m_writer.put(m_curr, code_width(m_next, m_max_width));
+			m_curr = NO_CODE;
+			m_writer.flush();
+		}
+
+		private:
+		// writes the current code and defines the current string + `c`
+		inline void emit(uint8_t c){
+			m_writer.put(m_curr, code_width(m_next, m_max_width));
+			if(m_next < m_limit){
+				m_dictionary.insert(m_curr, c, m_next);
+				if(m_policy == PRUNE){
+					if(m_next >= m_entries.size())
+						m_entries.resize(2 * m_entries.size());
+					m_entries[m_next] = std::make_pair(m_curr, c);
+					m_recency.touch(m_curr);
+					m_recency.add(m_next, m_curr);
+				}
+				++m_next;
+			} else if(m_policy == RESET){
+				m_writer.put(CLEAR_CODE, m_max_width);
+				m_dictionary.clear();
+				m_next = FIRST_CODE;
+			} else if(m_policy == PRUNE){
+				m_recency.touch(m_curr);
+				uint32_t victim = m_recency.oldest();
+				// the current string may be the only leaf (e.g. a run of one byte)
+				if(victim != NO_CODE && victim != m_curr){
+					m_dictionary.erase(m_entries[victim].first, m_entries[victim].second);
+					m_recency.remove(victim, m_entries[victim].first);
+					m_dictionary.insert(m_curr, c, victim);
+					m_entries[victim] = std::make_pair(m_curr, c);
+					m_recency.add(victim, m_curr);
+				}
+			}
+		}
+	};
+
+	inline compressed_data_t compress(const std::string& data, size_t max_width=DEFAULT_CODE_WIDTH, policy_t policy=RESET){
+		compressed_data_t out;
+		if(data.empty())
+			return out;
+
+		Encoder encoder(out, max_width, policy);
+		encoder.encode(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+		encoder.finish();
 		return out;
 	}
 
-	std::string decompress(const compressed_data_t& data){
+	// reads the header byte written by compress
+	inline bool read_header(uint8_t header, size_t& max_width, policy_t& policy){
+		max_width = header & 31;
+		if(max_width < MIN_CODE_WIDTH || max_width > MAX_CODE_WIDTH || (header >> 5) > PRUNE){
+			fprintf(stderr, "WARNING[lzw::decompress]: Invalid header!\n");
+			return false;
+		}
+		policy = static_cast<policy_t>(header >> 5);
+		return true;
+	}
+
+	/* Decoder class
+	 *
+	 * Mirror of the compressor's dictionary. An entry is the code of its
+	 * prefix, its last byte and its length, so defining a string costs no
+	 * allocation and a string is written straight into the output: its
+	 * length says where it ends and the prefix chain is walked backwards
+	 * from there. Codes are fed one at a time, read with width() bits each.
+	 */
+	class Decoder{
+		public:
+		static const size_t INVALID = SIZE_MAX;
+
+		private:
+		std::vector<entry_t> m_entries;
+		Recency m_recency;
+		size_t m_max_width;
+		policy_t m_policy;
+		uint32_t m_limit;
+		uint32_t m_next;
+		uint32_t m_prev;	// last code, NO_CODE right after a reset
+		uint8_t m_prev_first;	// first byte of the last string
+		// code the compressor gave to the last string + the next byte, or NO_CODE
+		uint32_t m_slot;
+
+		public:
+		// the entries start with room for INITIAL_CAPACITY codes and double as they are defined
+		Decoder(size_t max_width=DEFAULT_CODE_WIDTH, policy_t policy=RESET):
+			m_entries(std::min(static_cast<size_t>(1) << max_width, INITIAL_CAPACITY)),
+			m_recency(policy == PRUNE ? INITIAL_CAPACITY : 0),
+			m_max_width(max_width), m_policy(policy), m_limit(1u << max_width){
+			for(uint32_t c=0; c<ALPHABET_SIZE; ++c)
+				m_entries[c] = entry_t{NO_CODE, 1, static_cast<uint8_t>(c)};
+			reset();
+		}
+
+		// number of bits of the next code
+		inline size_t width() const{ return code_width(m_next, m_max_width); }
+
+		// number of bytes `code` decodes to: 0 for a CLEAR_CODE, INVALID if it is undefined
+		inline size_t length(uint32_t code) const{
+			if(code == m_slot)
+				return m_entries[m_prev].length + 1;
+			if(code < ALPHABET_SIZE || (code >= FIRST_CODE && code < m_next))
+				return m_entries[code].length;
+			return code == CLEAR_CODE && m_policy == RESET ? 0 : INVALID;
+		}
+
+		/* Args:
+		 * 	code	- next code, of length(code) != INVALID
+		 * 	dest	- where its length(code) bytes are written
+		 */
+		inline void decode(uint32_t code, uint8_t* dest){
+			if(code == CLEAR_CODE && m_policy == RESET){
+				m_recency.clear();
+				reset();
+				return;
+			}
+
+			if(code == m_slot)	// the code being defined by this very step (cScSc)
+				define(m_prev_first);
+			uint8_t* ptr = dest + m_entries[code].length;
+			for(uint32_t i=code; i!=NO_CODE; i=m_entries[i].prefix)
+				*--ptr = m_entries[i].byte;
+			if(m_slot != NO_CODE && code != m_slot)
+				define(dest[0]);
+
+			if(m_policy == PRUNE)
+				m_recency.touch(code);
+			m_prev = code;
+			m_prev_first = dest[0];
+			prepare();
+		}
+
+		private:
+		inline void reset(){
+			m_next = FIRST_CODE;
+			m_prev = m_slot = NO_CODE;
+		}
+
+		inline void define(uint8_t byte){
+			m_entries[m_slot] = entry_t{m_prev, m_entries[m_prev].length + 1, byte};
+			if(m_policy == PRUNE)
+				m_recency.add(m_slot, m_prev);
+		}
+
+		// picks the code the compressor defined right after emitting the last one
+		inline void prepare(){
+			m_slot = NO_CODE;
+			if(m_next < m_limit){
+				m_slot = m_next++;
+				if(m_slot >= m_entries.size())
+					m_entries.resize(2 * m_entries.size());
+			} else if(m_policy == PRUNE){
+				uint32_t victim = m_recency.oldest();
+				if(victim != NO_CODE && victim != m_prev){
+					m_recency.remove(victim, m_entries[victim].prefix);
+					m_slot = victim;
+				}
+			}
+		}
+	};
+
+	/* Args:
+	 * 	src		- compressed data
+	 * 	size		- number of bytes of `src`
+	 * 	dest		- output buffer reserved by the caller
+	 * 	capacity	- number of bytes of `dest`
+	 *
+	 * Returns the number of bytes written, or Decoder::INVALID if the data
+	 * is corrupt or does not fit.
+	 */
+	inline size_t decompress(const uint8_t* src, size_t size, uint8_t* dest, size_t capacity){
+		if(!size)
+			return 0;
+		size_t max_width;
+		policy_t policy;
+		if(!read_header(src[0], max_width, policy))
+			return Decoder::INVALID;
+
+		Decoder decoder(max_width, policy);
+		BitReader in(src + 1, size - 1);
+		size_t pos = 0;
+		while(in.bit_size() - in.position() >= decoder.width()){
+			uint32_t code = in.get(decoder.width());
+			size_t length = decoder.length(code);
+			if(length == Decoder::INVALID || length > capacity - pos){
+				fprintf(stderr, "WARNING[lzw::decompress]: %s code %u!\n", length == Decoder::INVALID ? "Invalid" : "Overflowing", code);
+				return Decoder::INVALID;
+			}
+			decoder.decode(code, dest + pos);
+			pos += length;
+		}
+		return pos;
+	}
+
+	inline std::string decompress(const compressed_data_t& data){
 		std::string out;
-		table_t table(128);
-
-		// Initializing the table
-		for(unsigned char c=0; c<128; ++c)
-			table[c] = std::string(1, c);
-
-		// Decompressing
-		size_t index;
-		std::string curr = table[data[0]], tmp;
-		out = curr;
-		for(size_t i=1; i<data.size(); ++i){
-			index = data[i];
-			if(index >= table.size()){
-				tmp += tmp[tmp.size()-1];
-			} else{
-				tmp = curr + table[index];
-				// curr = table[index];
+		if(data.empty())
+			return out;
+		size_t max_width;
+		policy_t policy;
+		if(!read_header(data[0], max_width, policy))
+			return out;
+
+		// the buffer doubles whenever a string does not fit, never per code
+		Decoder decoder(max_width, policy);
+		BitReader in(data.data() + 1, data.size() - 1);
+		out.resize(4 * data.size());
+		size_t pos = 0;
+		while(in.bit_size() - in.position() >= decoder.width()){
+			uint32_t code = in.get(decoder.width());
+			size_t length = decoder.length(code);
+			if(length == Decoder::INVALID){
+				fprintf(stderr, "WARNING[lzw::decompress]: Invalid code %u!\n", code);
+				break;
 			}
-			out += tmp;
-			table.push_back(tmp);
+			if(pos + length > out.size())
+				out.resize(std::max(2 * out.size(), pos + length));
+			decoder.decode(code, reinterpret_cast<uint8_t*>(&out[pos]));
+			pos += length;
 		}
+		out.resize(pos);
 
 		return out;
 	}
+
+	// input bytes read (or compressed bytes decoded) per chunk by the streaming functions
+	static const size_t CHUNK_SIZE = 1 << 16;
+
+	/* Args:
+	 * 	read	- size_t(void* dest, size_t size), short only at the end of the input
+	 * 	write	- bool(const void* src, size_t size), false on an error
+	 *
+	 * Memory stays bounded by the chunk size and the dictionary, whatever
+	 * the size of the input. The output is the same as compress(string).
+	 */
+	template<typename Read, typename Write>
+	inline bool compress_stream(Read read, Write write, size_t max_width, policy_t policy, size_t chunk_size){
+		std::vector<uint8_t> in(chunk_size ? chunk_size : CHUNK_SIZE), out;
+		out.reserve(2 * in.size());
+		Encoder encoder(out, max_width, policy);
+
+		size_t size;
+		do{
+			size = read(in.data(), in.size());
+			encoder.encode(in.data(), size);
+			if(size < in.size())
+				encoder.finish();
+			if(!write(out.data(), out.size()))
+				return false;
+			out.clear();
+		} while(size == in.size());
+		return true;
+	}
+
+	template<typename Read, typename Write>
+	inline bool decompress_stream(Read read, Write write, size_t chunk_size){
+		uint8_t header;
+		if(read(&header, 1) != 1)
+			return true;
+		size_t max_width;
+		policy_t policy;
+		if(!read_header(header, max_width, policy))
+			return false;
+
+		// a code left over from the previous chunk is kept in front of the next one
+		if(!chunk_size)
+			chunk_size = CHUNK_SIZE;
+		std::vector<uint8_t> in(chunk_size + 8), out(chunk_size);
+		Decoder decoder(max_width, policy);
+		size_t filled = 0, bit = 0, pos = 0;
+		bool end = false;
+		while(!end){
+			filled -= bit / 8;
+			memmove(in.data(), in.data() + bit / 8, filled);
+			bit %= 8;
+			size_t size = read(in.data() + filled, chunk_size);
+			filled += size;
+			end = size < chunk_size;
+
+			BitReader reader(in.data(), filled);
+			reader.skip(bit);
+			while(reader.bit_size() - reader.position() >= decoder.width()){
+				uint32_t code = reader.get(decoder.width());
+				size_t length = decoder.length(code);
+				if(length == Decoder::INVALID){
+					fprintf(stderr, "WARNING[lzw::decompress]: Invalid code %u!\n", code);
+					return false;
+				}
+				if(pos + length > out.size()){
+					if(!write(out.data(), pos))
+						return false;
+					pos = 0;
+					if(length > out.size())
+						out.resize(length);
+				}
+				decoder.decode(code, out.data() + pos);
+				pos += length;
+			}
+			bit = reader.position();
+		}
+		return write(out.data(), pos);
+	}
+
+	/* Args:
+	 * 	fd_in		- file descriptor to read the raw bytes from
+	 * 	fd_out		- file descriptor to write the compressed bytes to
+	 * 	max_width	- widest code (see Encoder)
+	 * 	policy		- what to do once the dictionary is full
+	 * 	chunk_size	- bytes read at a time
+	 *
+	 * 	Returns false on an I/O error
+	 */
+	inline bool compress(int fd_in, int fd_out, size_t max_width=DEFAULT_CODE_WIDTH, 
+			policy_t policy=RESET, size_t chunk_size=CHUNK_SIZE){
+		return compress_stream(
+			[fd_in](void* dest, size_t size){ return read_all(fd_in, dest, size); },
+			[fd_out](const void* src, size_t size){ return write_all(fd_out, src, size); },
+			max_width, policy, chunk_size);
+	}
+
+	// Returns false on an I/O error or corrupted input
+	inline bool decompress(int fd_in, int fd_out, size_t chunk_size=CHUNK_SIZE){
+		return decompress_stream(
+			[fd_in](void* dest, size_t size){ return read_all(fd_in, dest, size); },
+			[fd_out](const void* src, size_t size){ return write_all(fd_out, src, size); },
+			chunk_size);
+	}
+
+	inline bool compress(FILE* in, FILE* out, size_t max_width=DEFAULT_CODE_WIDTH, 
+			policy_t policy=RESET, size_t chunk_size=CHUNK_SIZE){
+		return compress_stream(
+			[in](void* dest, size_t size){ return fread(dest, 1, size, in); },
+			[out](const void* src, size_t size){ return fwrite(src, 1, size, out) == size; },
+			max_width, policy, chunk_size);
+	}
+
+	inline bool decompress(FILE* in, FILE* out, size_t chunk_size=CHUNK_SIZE){
+		return decompress_stream(
+			[in](void* dest, size_t size){ return fread(dest, 1, size, in); },
+			[out](const void* src, size_t size){ return fwrite(src, 1, size, out) == size; },
+			chunk_size);
+	}
+
+	static const size_t BLOCK_SIZE = 1 << 22;
+	static const char BLOCKS_MAGIC[4] = { 'L', 'Z', 'W', 'P' };
+
+	/* Block format
+	 *
+	 * 	"LZWP" header index blocks
+	 * 	header	- raw size (u64), block size (u32), block count (u32)
+	 * 	index	- byte offset of every block from the start of the blocks (u64)
+	 * 	block	- output of an Encoder over `block size` input bytes
+	 *
+	 * Integers are big-endian. Every block starts with a fresh dictionary,
+	 * which costs some ratio (the first strings of a block are short again)
+	 * but makes the blocks independent: both directions run one block per
+	 * worker thread and a block can be decoded on its own.
+	 */
+
+	/* Args:
+	 * 	src				- input bytes
+	 * 	size			- number of bytes
+	 * 	block_size		- input bytes per block
+	 * 	thread_count	- maximum number of worker threads (0: one per core)
+	 * 	max_width		- widest code (see Encoder)
+	 * 	policy			- what to do once a dictionary is full
+	 */
+	inline std::vector<uint8_t> compress_blocks(const uint8_t* src, size_t size, size_t block_size=BLOCK_SIZE, 
+			size_t thread_count=0, size_t max_width=DEFAULT_CODE_WIDTH, policy_t policy=RESET){
+		if(!block_size || block_size > UINT32_MAX)
+			block_size = BLOCK_SIZE;
+		size_t block_count = (size + block_size - 1) / block_size;
+
+		std::vector<std::vector<uint8_t>> blocks(block_count);
+		parallel_for(block_count, thread_count, [&](size_t i){
+			size_t count = std::min(block_size, size - i * block_size);
+			Encoder encoder(blocks[i], max_width, policy);
+			encoder.encode(src + i * block_size, count);
+			encoder.finish();
+		});
+
+		std::vector<uint8_t> out(BLOCKS_MAGIC, BLOCKS_MAGIC+sizeof(BLOCKS_MAGIC));
+		put_u64(out, size);
+		put_u32(out, block_size);
+		put_u32(out, block_count);
+
+		size_t offset = 0;
+		for(const auto& block: blocks){
+			put_u64(out, offset);
+			offset += block.size();
+		}
+		out.reserve(out.size() + offset);
+		for(const auto& block: blocks)
+			out.insert(out.end(), block.cbegin(), block.cend());
+		return out;
+	}
+
+	/* Args:
+	 * 	src				- output of compress_blocks
+	 * 	size			- number of bytes
+	 * 	out				- decompressed bytes
+	 * 	thread_count	- maximum number of worker threads (0: one per core)
+	 *
+	 * 	Returns false if the input is corrupted
+	 */
+	inline bool decompress_blocks(const uint8_t* src, size_t size, std::vector<uint8_t>& out, size_t thread_count=0){
+		const size_t HEADER_SIZE = sizeof(BLOCKS_MAGIC) + 8 + 4 + 4;
+		if(size < HEADER_SIZE || !std::equal(BLOCKS_MAGIC, BLOCKS_MAGIC+sizeof(BLOCKS_MAGIC), reinterpret_cast<const char*>(src))){
+			fprintf(stderr, "WARNING[lzw::decompress_blocks]: Not an lzw block stream!\n");
+			return false;
+		}
+		uint64_t raw_size = get_u64(src+4);
+		size_t block_size = get_u32(src+12), block_count = get_u32(src+16);
+		if(!block_size || block_count != (raw_size + block_size - 1) / block_size || 
+				(size - HEADER_SIZE) / 8 < block_count){
+			fprintf(stderr, "WARNING[lzw::decompress_blocks]: Corrupted header!\n");
+			return false;
+		}
+
+		const uint8_t* index = src + HEADER_SIZE;
+		const uint8_t* blocks = index + 8 * block_count;
+		size_t blocks_size = size - HEADER_SIZE - 8 * block_count;
+		// the k-th code of a block decodes to at most k bytes, so n codes (of 9 bits or more) to n(n+1)/2
+		uint64_t codes = 8 * static_cast<uint64_t>(blocks_size) / MIN_CODE_WIDTH;
+		if(!index_fits(index, block_count, blocks_size) || (codes && raw_size / codes > (codes + 1) / 2) ||
+				(!codes && raw_size)){
+			fprintf(stderr, "WARNING[lzw::decompress_blocks]: Corrupted header!\n");
+			return false;
+		}
+
+		// every block is decoded straight into its place in the output
+		out.resize(raw_size);
+		std::atomic<bool> ok(true);
+		parallel_for(block_count, thread_count, [&](size_t i){
+			// a block ends where the next one starts
+			uint64_t offset = get_u64(index + 8 * i);
+			uint64_t end = i+1 < block_count ? get_u64(index + 8 * (i+1)) : blocks_size;
+			size_t count = std::min<uint64_t>(block_size, raw_size - i * block_size);
+			if(!ok || end > blocks_size || offset > end){
+				ok = false;
+				return;
+			}
+			if(decompress(blocks + offset, end - offset, out.data() + i * block_size, count) != count)
+				ok = false;
+		});
+
+		if(!ok)
+			fprintf(stderr, "WARNING[lzw::decompress_blocks]: Corrupted block!\n");
+		return ok;
+	}
 }
 
+#endif
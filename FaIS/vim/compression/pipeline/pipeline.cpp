@@ -0,0 +1,65 @@
+#include "pipeline.h"
+#include <fcntl.h>
+#include <string.h>
+#include <sstream>
+
+using namespace std;
+using namespace pipeline;
+
+// "-" stands for the standard input/output
+int open_file(const char* path, bool output){
+	if(!strcmp(path, "-"))
+		return output ? STDOUT_FILENO : STDIN_FILENO;
+	return output ? open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644) : open(path, O_RDONLY);
+}
+
+// "lz77,huffman" -> lz77 stage followed by a huffman stage
+bool build(const string& stages, Pipeline& pipeline){
+	stringstream ss(stages);
+	for(string name; getline(ss, name, ','); ){
+		auto codec = make_codec(name);
+		if(!codec){
+			fprintf(stderr, "ERROR: Unknown codec %s!\n", name.c_str());
+			return false;
+		}
+		pipeline.then(std::move(codec));
+	}
+	return true;
+}
+
+int main(int argc, const char** argv){
+	// -c <stages>: compression through the given stages, -d: decompression
+	const string mode = argc > 1 ? argv[1] : "";
+	if((mode == "-c" && argc == 5) || (mode == "-d" && argc == 4)){
+		const char* input = argv[argc-2];
+		const char* output = argv[argc-1];
+		int fd_in = open_file(input, false), fd_out = open_file(output, true);
+		if(fd_in < 0 || fd_out < 0){
+			fprintf(stderr, "ERROR: Unable to open %s!\n", fd_in < 0 ? input : output);
+			return 1;
+		}
+
+		Pipeline pipeline;
+		bool ok = mode == "-c" ? build(argv[2], pipeline) && pipeline.compress(fd_in, fd_out) :
+			Pipeline::decompress(fd_in, fd_out);
+		close(fd_in);
+		close(fd_out);
+		return !ok;
+	} else if(argc > 2){
+		fprintf(stderr, "Usage: %s [text] | -c <codec,...> <input> <output> | -d <input> <output>\n", argv[0]);
+		fprintf(stderr, "Codecs: raw, huffman, lzw, lz77, bwt, fse\n");
+		return 1;
+	}
+
+	string text = "hello, my name is world and this is an example of a compression pipeline, an example of lz77 and huffman.";
+	if(argc == 2) text = string(argv[1]);
+	Pipeline pipeline;
+	pipeline.then(new Lz77Codec()).then(new HuffmanCodec());
+	block_t encoded, decoded;
+	pipeline.encode(block_t(text.begin(), text.end()), encoded);
+	pipeline.decode(encoded, decoded);
+	printf("%s\n", string(decoded.begin(), decoded.end()).c_str());
+	printf("Compression Ratio: %.3f\n", ((float)text.size()-encoded.size())/text.size());
+	printf("%zu - %zu\n", encoded.size(), text.size());
+	return 0;
+}
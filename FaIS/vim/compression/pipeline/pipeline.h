@@ -0,0 +1,567 @@
+
+#ifndef _PIPELINE_
+#define _PIPELINE_
+
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include "../huffman/huffman.h"
+#include "../lzw/lzw.h"
+#include "../lz77/lz77.h"
+#include "../bwt/bwt.h"
+#include "../fse/fse.h"
+
+
+namespace pipeline{
+	using block_t = std::vector<uint8_t>;
+
+	// input bytes per block of a stream
+	static const size_t BLOCK_SIZE = 1 << 20;
+	// blocks buffered between two stages
+	static const size_t QUEUE_SIZE = 2;
+	static const char MAGIC[4] = { 'P', 'I', 'P', 'E' };
+
+	enum codec_id_t{ RAW=0, HUFFMAN=1, LZW=2, LZ77=3, BWT=4, FSE=5, CODEC_COUNT };
+
+	/* Codec class
+	 *
+	 * Block transform: encode() maps a block to a self-describing block and
+	 * decode() maps it back, so a decoder needs nothing but the codec id.
+	 * A codec keeps no state between blocks, and different blocks may be
+	 * coded by different threads as long as each has its own codec.
+	 */
+	class Codec{
+		public:
+		virtual ~Codec() = default;
+
+		virtual codec_id_t id() const = 0;
+		virtual const char* name() const = 0;
+		// `out` is replaced; false if `in` cannot be coded
+		virtual bool encode(const block_t& in, block_t& out) = 0;
+		virtual bool decode(const block_t& in, block_t& out) = 0;
+	};
+
+	class RawCodec: public Codec{
+		public:
+		codec_id_t id() const{ return RAW; }
+		const char* name() const{ return "raw"; }
+		bool encode(const block_t& in, block_t& out){
+			out = in;
+			return true;
+		}
+		bool decode(const block_t& in, block_t& out){
+			out = in;
+			return true;
+		}
+	};
+
+	// raw size (u32), huffman record (see huffman::encode_block)
+	class HuffmanCodec: public Codec{
+		private:
+		size_t m_tables;
+
+		public:
+		// tables: order-1 code tables (0: order-0)
+		explicit HuffmanCodec(size_t tables=0): m_tables(tables) {}
+
+		codec_id_t id() const{ return HUFFMAN; }
+		const char* name() const{ return "huffman"; }
+		bool encode(const block_t& in, block_t& out){
+			if(in.size() > UINT32_MAX)
+				return false;
+			out.clear();
+			put_u32(out, in.size());
+			huffman::encode_block(in.data(), in.size(), out, huffman::MAX_CODE_LENGTH, true, m_tables);
+			return true;
+		}
+		bool decode(const block_t& in, block_t& out){
+			if(in.size() < 4)
+				return false;
+			out.resize(get_u32(in.data()));
+			return huffman::decode_block(in.data() + 4, in.size() - 4, out.data(), out.size());
+		}
+	};
+
+	// raw size (u32), lzw codes (see lzw::Encoder)
+	class LzwCodec: public Codec{
+		private:
+		size_t m_max_width;
+		lzw::policy_t m_policy;
+
+		public:
+		explicit LzwCodec(size_t max_width=lzw::DEFAULT_CODE_WIDTH, lzw::policy_t policy=lzw::RESET):
+			m_max_width(max_width), m_policy(policy) {}
+
+		codec_id_t id() const{ return LZW; }
+		const char* name() const{ return "lzw"; }
+		bool encode(const block_t& in, block_t& out){
+			if(in.size() > UINT32_MAX)
+				return false;
+			out.clear();
+			put_u32(out, in.size());
+			lzw::Encoder encoder(out, m_max_width, m_policy);
+			encoder.encode(in.data(), in.size());
+			encoder.finish();
+			return true;
+		}
+		bool decode(const block_t& in, block_t& out){
+			if(in.size() < 4)
+				return false;
+			out.resize(get_u32(in.data()));
+			return lzw::decompress(in.data() + 4, in.size() - 4, out.data(), out.size()) == out.size();
+		}
+	};
+
+	/* LZ77 tokens split into byte streams, each huffman coded with its own table:
+	 *
+	 * 	header	- raw size (u32), window bits (u8), token count (u32), match count (u32),
+	 * 			  record size of every stream (u32 each)
+	 * 	flags	- 1 bit per token, set for a match (MSB-first, padded)
+	 * 	symbols	- the byte of every literal or length - MIN_MATCH of every match
+	 * 	planes	- distance - 1 of every match, one byte plane per stream
+	 * 			  from the most significant
+	 *
+	 * Literals and lengths share one alphabet, as in deflate, while the
+	 * flags and every distance plane get a code table of their own, so
+	 * the high distance bytes do not share statistics with the text.
+	 */
+	class Lz77Codec: public Codec{
+		private:
+		size_t m_window_bits;
+		size_t m_chain;
+
+		public:
+		explicit Lz77Codec(size_t window_bits=20, size_t chain=lz77::DEFAULT_CHAIN):
+			m_window_bits(std::max(lz77::MIN_WINDOW_BITS, std::min(window_bits, lz77::MAX_WINDOW_BITS))),
+			m_chain(chain) {}
+
+		codec_id_t id() const{ return LZ77; }
+		const char* name() const{ return "lz77"; }
+		bool encode(const block_t& in, block_t& out){
+			if(in.size() > UINT32_MAX)
+				return false;
+			std::vector<block_t> streams(2 + plane_count(m_window_bits));
+			std::vector<uint32_t> distances;
+			BitWriter writer(streams[0]);
+			lz77::parse(in.data(), in.size(), [&](const lz77::token_t& token){
+				writer.put_bit(token.length != 0);
+				if(token.length){
+					streams[1].push_back(token.length - lz77::MIN_MATCH);
+					distances.push_back(token.value - 1);
+				} else{
+					streams[1].push_back(token.value);
+				}
+			}, m_window_bits, m_chain, true);
+			writer.flush();
+			for(size_t plane=0; plane+2<streams.size(); ++plane){
+				size_t shift = 8 * (streams.size() - 3 - plane);
+				for(const auto& distance: distances)
+					streams[2 + plane].push_back(distance >> shift);
+			}
+
+			out.clear();
+			put_u32(out, in.size());
+			out.push_back(m_window_bits);
+			put_u32(out, streams[1].size());
+			put_u32(out, distances.size());
+			size_t sizes = out.size();
+			out.resize(sizes + 4 * streams.size());
+			for(size_t k=0; k<streams.size(); ++k){
+				size_t start = out.size();
+				huffman::encode_block(streams[k].data(), streams[k].size(), out);
+				uint32_t size = out.size() - start;
+				out[sizes+4*k] = size >> 24; out[sizes+4*k+1] = size >> 16;
+				out[sizes+4*k+2] = size >> 8; out[sizes+4*k+3] = size;
+			}
+			return true;
+		}
+		bool decode(const block_t& in, block_t& out){
+			const size_t HEADER_SIZE = 4 + 1 + 4 + 4;
+			if(in.size() < HEADER_SIZE)
+				return false;
+			size_t raw_size = get_u32(in.data()), window_bits = in[4];
+			size_t token_count = get_u32(in.data() + 5), match_count = get_u32(in.data() + 9);
+			size_t planes = plane_count(window_bits);
+			// a token stands for at least one byte
+			if(match_count > token_count || token_count > raw_size || window_bits > lz77::MAX_WINDOW_BITS ||
+					in.size() - HEADER_SIZE < 4 * (2 + planes))
+				return false;
+
+			std::vector<block_t> streams(2 + planes);
+			const uint8_t* record = in.data() + HEADER_SIZE + 4 * streams.size();
+			const uint8_t* end = in.data() + in.size();
+			for(size_t k=0; k<streams.size(); ++k){
+				size_t size = get_u32(in.data() + HEADER_SIZE + 4 * k);
+				if(size > static_cast<size_t>(end - record))
+					return false;
+				streams[k].resize(k == 0 ? (token_count + 7) / 8 : k == 1 ? token_count : match_count);
+				if(!huffman::decode_block(record, size, streams[k].data(), streams[k].size()))
+					return false;
+				record += size;
+			}
+			if(record != end)
+				return false;
+
+			const uint8_t* symbols = streams[1].data();
+			BitReader flags(streams[0].data(), streams[0].size());
+			out.resize(raw_size);
+			size_t pos = 0, match = 0;
+			for(size_t i=0; i<token_count; ++i){
+				if(!flags.get_bit()){
+					if(pos == raw_size)
+						return false;
+					out[pos++] = symbols[i];
+					continue;
+				}
+
+				size_t length = symbols[i] + lz77::MIN_MATCH, distance = 0;
+				if(match == match_count)
+					return false;
+				for(size_t plane=0; plane<planes; ++plane)
+					distance = distance << 8 | streams[2 + plane][match];
+				++distance;
+				++match;
+				if(distance > pos || length > raw_size - pos)
+					return false;
+				for(size_t j=0; j<length; ++j, ++pos)
+					out[pos] = out[pos - distance];
+			}
+			return pos == raw_size;
+		}
+
+		private:
+		static inline size_t plane_count(size_t window_bits){ return (window_bits + 7) / 8; }
+	};
+
+	// raw size (u32), bwt block record (see bwt::encode_block)
+	class BwtCodec: public Codec{
+		private:
+		size_t m_tables;
+
+		public:
+		// tables: order-1 huffman code tables (0: order-0)
+		explicit BwtCodec(size_t tables=0): m_tables(tables) {}
+
+		codec_id_t id() const{ return BWT; }
+		const char* name() const{ return "bwt"; }
+		bool encode(const block_t& in, block_t& out){
+			if(in.size() > bwt::MAX_BLOCK_SIZE)
+				return false;
+			out.clear();
+			put_u32(out, in.size());
+			bwt::encode_block(in.data(), in.size(), out, m_tables);
+			return true;
+		}
+		bool decode(const block_t& in, block_t& out){
+			if(in.size() < 4)
+				return false;
+			out.resize(get_u32(in.data()));
+			return bwt::decode_block(in.data() + 4, in.size() - 4, out.data(), out.size());
+		}
+	};
+
+	// raw size (u32), fse record (see fse::encode_block)
+	class FseCodec: public Codec{
+		private:
+		size_t m_table_log;
+
+		public:
+		// table_log: preferred table size (see fse::choose_table_log)
+		explicit FseCodec(size_t table_log=fse::DEFAULT_TABLE_LOG): m_table_log(table_log) {}
+
+		codec_id_t id() const{ return FSE; }
+		const char* name() const{ return "fse"; }
+		bool encode(const block_t& in, block_t& out){
+			if(in.size() > UINT32_MAX)
+				return false;
+			out.clear();
+			put_u32(out, in.size());
+			fse::encode_block(in.data(), in.size(), out, m_table_log);
+			return true;
+		}
+		bool decode(const block_t& in, block_t& out){
+			if(in.size() < 4)
+				return false;
+			out.resize(get_u32(in.data()));
+			return fse::decode_block(in.data() + 4, in.size() - 4, out.data(), out.size());
+		}
+	};
+
+	// codec of id `id` with its default parameters, nullptr if unknown
+	inline std::unique_ptr<Codec> make_codec(size_t id){
+		switch(id){
+			case RAW: return std::unique_ptr<Codec>(new RawCodec());
+			case HUFFMAN: return std::unique_ptr<Codec>(new HuffmanCodec());
+			case LZW: return std::unique_ptr<Codec>(new LzwCodec());
+			case LZ77: return std::unique_ptr<Codec>(new Lz77Codec());
+			case BWT: return std::unique_ptr<Codec>(new BwtCodec());
+			case FSE: return std::unique_ptr<Codec>(new FseCodec());
+			default: return nullptr;
+		}
+	}
+
+	// codec named `name` (as in Codec::name) with its default parameters, nullptr if unknown
+	inline std::unique_ptr<Codec> make_codec(const std::string& name){
+		for(size_t id=0; id<CODEC_COUNT; ++id){
+			auto codec = make_codec(id);
+			if(name == codec->name())
+				return codec;
+		}
+		return nullptr;
+	}
+
+	/* Queue class
+	 *
+	 * Bounded blocking FIFO between two pipeline stages. close() wakes up
+	 * everyone: pop() still drains what is left, push() fails at once.
+	 */
+	template<typename T>
+	class Queue{
+		private:
+		std::deque<T> m_items;
+		size_t m_capacity;
+		bool m_closed;
+		std::mutex m_mutex;
+		std::condition_variable m_not_empty, m_not_full;
+
+		public:
+		explicit Queue(size_t capacity=QUEUE_SIZE): m_capacity(capacity ? capacity : 1), m_closed(false) {}
+
+		inline bool push(T&& item){
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_not_full.wait(lock, [this](){ return m_closed || m_items.size() < m_capacity; });
+			if(m_closed)
+				return false;
+			m_items.push_back(std::move(item));
+			m_not_empty.notify_one();
+			return true;
+		}
+
+		inline bool pop(T& item){
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_not_empty.wait(lock, [this](){ return m_closed || !m_items.empty(); });
+			if(m_items.empty())
+				return false;
+			item = std::move(m_items.front());
+			m_items.pop_front();
+			m_not_full.notify_one();
+			return true;
+		}
+
+		inline void close(){
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_closed = true;
+			m_not_empty.notify_all();
+			m_not_full.notify_all();
+		}
+	};
+
+	/* Stream format
+	 *
+	 * 	"PIPE" stage count (u8) codec id of every stage (u8) blocks end
+	 * 	block	- encoded size (u32, never 0), output of the last stage
+	 * 	end		- 0 (u32)
+	 *
+	 * Integers are big-endian. The stages are listed in encoding order;
+	 * decoding runs them backwards.
+	 */
+
+	/* Pipeline class
+	 *
+	 * Chain of codecs built stage by stage, e.g.
+	 * 	Pipeline pipeline;
+	 * 	pipeline.then(new Lz77Codec()).then(new HuffmanCodec());
+	 * A stream is cut into blocks and every stage runs on its own thread,
+	 * handing blocks to the next one through a bounded Queue: while a
+	 * stage codes block i, the previous one already works on block i+1.
+	 */
+	class Pipeline{
+		private:
+		std::vector<std::unique_ptr<Codec>> m_stages;
+		size_t m_block_size;
+
+		public:
+		explicit Pipeline(size_t block_size=BLOCK_SIZE):
+			m_block_size(block_size && block_size <= UINT32_MAX ? block_size : BLOCK_SIZE) {}
+
+		// appends a stage (the pipeline takes ownership)
+		inline Pipeline& then(Codec* codec){
+			m_stages.emplace_back(codec);
+			return *this;
+		}
+		inline Pipeline& then(std::unique_ptr<Codec> codec){
+			m_stages.push_back(std::move(codec));
+			return *this;
+		}
+
+		inline size_t size() const{ return m_stages.size(); }
+		inline const Codec& stage(size_t i) const{ return *m_stages[i]; }
+
+		// runs a block through every stage on the calling thread
+		inline bool encode(const block_t& in, block_t& out) const{
+			out = in;
+			block_t tmp;
+			for(const auto& stage: m_stages){
+				if(!stage->encode(out, tmp))
+					return false;
+				out.swap(tmp);
+			}
+			return true;
+		}
+		inline bool decode(const block_t& in, block_t& out) const{
+			out = in;
+			block_t tmp;
+			for(size_t i=m_stages.size(); i--; ){
+				if(!m_stages[i]->decode(out, tmp))
+					return false;
+				out.swap(tmp);
+			}
+			return true;
+		}
+
+		/* Args:
+		 * 	fd_in	- file descriptor to read the raw bytes from
+		 * 	fd_out	- file descriptor to write the stream format to
+		 *
+		 * 	Returns false on an I/O or coding error
+		 */
+		inline bool compress(int fd_in, int fd_out) const{
+			block_t header(MAGIC, MAGIC+sizeof(MAGIC));
+			header.push_back(m_stages.size());
+			for(const auto& stage: m_stages)
+				header.push_back(stage->id());
+			if(m_stages.size() > UINT8_MAX || !write_all(fd_out, header.data(), header.size()))
+				return false;
+
+			size_t block_size = m_block_size;
+			bool ok = run(true,
+				[fd_in, block_size](block_t& block){
+					block.resize(block_size);
+					block.resize(read_all(fd_in, block.data(), block.size()));
+					return !block.empty();
+				},
+				[fd_out](const block_t& block){
+					block_t size;
+					put_u32(size, block.size());
+					return !block.empty() && block.size() <= UINT32_MAX &&
+						write_all(fd_out, size.data(), size.size()) &&
+						write_all(fd_out, block.data(), block.size());
+				});
+
+			block_t end;
+			put_u32(end, 0);
+			return ok && write_all(fd_out, end.data(), end.size());
+		}
+
+		/* Args:
+		 * 	fd_in	- file descriptor to read the stream format from
+		 * 	fd_out	- file descriptor to write the raw bytes to
+		 *
+		 * 	The stages are taken from the stream. Returns false on an I/O
+		 * 	error or corrupted input
+		 */
+		static inline bool decompress(int fd_in, int fd_out){
+			uint8_t header[5];
+			if(read_all(fd_in, header, 5) != 5 ||
+					!std::equal(MAGIC, MAGIC+sizeof(MAGIC), reinterpret_cast<const char*>(header))){
+				fprintf(stderr, "WARNING[pipeline::decompress]: Not a pipeline stream!\n");
+				return false;
+			}
+
+			Pipeline pipeline;
+			for(size_t i=0; i<header[4]; ++i){
+				uint8_t id;
+				std::unique_ptr<Codec> codec;
+				if(read_all(fd_in, &id, 1) != 1 || !(codec = make_codec(id))){
+					fprintf(stderr, "WARNING[pipeline::decompress]: Unknown codec!\n");
+					return false;
+				}
+				pipeline.then(std::move(codec));
+			}
+
+			bool end = false;
+			bool ok = pipeline.run(false,
+				[fd_in, &end](block_t& block){
+					uint8_t size[4];
+					if(end || read_all(fd_in, size, 4) != 4)
+						return false;
+					block.resize(get_u32(size));
+					end = block.empty();
+					return !end && read_all(fd_in, block.data(), block.size()) == block.size();
+				},
+				[fd_out](const block_t& block){
+					return write_all(fd_out, block.data(), block.size());
+				});
+			if(ok && !end)
+				fprintf(stderr, "WARNING[pipeline::decompress]: Truncated stream!\n");
+			return ok && end;
+		}
+
+		private:
+		/* Args:
+		 * 	forward	- encode (true) or decode (false) the blocks
+		 * 	read	- bool(block_t&), fills the next block; false at the end
+		 * 	write	- bool(const block_t&), false on an error
+		 *
+		 * `read` runs on the calling thread, every stage and `write` on a
+		 * thread of their own. The first failure closes every queue, so the
+		 * other threads drain and stop.
+		 */
+		template<typename Read, typename Write>
+		inline bool run(bool forward, const Read& read, const Write& write) const{
+			size_t count = m_stages.size();
+			std::vector<std::unique_ptr<Queue<block_t>>> queues;
+			for(size_t i=0; i<=count; ++i)
+				queues.emplace_back(new Queue<block_t>());
+			std::atomic<bool> ok(true);
+			auto fail = [&](){
+				ok = false;
+				for(auto& queue: queues)
+					queue->close();
+			};
+
+			std::vector<std::thread> threads;
+			for(size_t i=0; i<count; ++i){
+				Codec* codec = m_stages[forward ? i : count - 1 - i].get();
+				threads.emplace_back([&, codec, i](){
+					block_t in, out;
+					while(queues[i]->pop(in)){
+						if(!(forward ? codec->encode(in, out) : codec->decode(in, out))){
+							fprintf(stderr, "WARNING[pipeline::Pipeline]: %s stage failed!\n", codec->name());
+							fail();
+							break;
+						}
+						if(!queues[i+1]->push(std::move(out)))
+							break;
+						out = block_t();
+					}
+					queues[i+1]->close();
+				});
+			}
+			threads.emplace_back([&](){
+				block_t block;
+				while(queues[count]->pop(block)){
+					if(!write(block)){
+						fail();
+						break;
+					}
+				}
+			});
+
+			while(ok){
+				block_t block;
+				if(!read(block))
+					break;
+				if(!queues[0]->push(std::move(block)))
+					break;
+			}
+			queues[0]->close();
+			for(auto& thread: threads)
+				thread.join();
+			return ok;
+		}
+	};
+}
+
+#endif